@@ -0,0 +1,52 @@
+#!/bin/sh
+# Generate a large C-- program for benchmarking.
+# usage: gen_large.sh [number of functions] > large.cmm
+# Names are made unique per function, as all symbols share one scope when generating code.
+n=${1:-2000}
+echo "struct Pair"
+echo "{"
+echo "    int pa;"
+echo "    int pb[4];"
+echo "};"
+i=0
+while [ $i -lt $n ]; do
+cat <<END
+int f$i(int a$i[4], int n$i)
+{
+    int i$i = 0, s$i = 0;
+    struct Pair p$i;
+    while(i$i < 4)
+    {
+        p$i.pb[i$i] = a$i[i$i] * 2 + n$i;
+        if(p$i.pb[i$i] > 10)
+        {
+            s$i = s$i + p$i.pb[i$i];
+        }
+        else
+        {
+            s$i = s$i - (n$i / 2);
+        }
+        i$i = i$i + 1;
+    }
+    return s$i;
+}
+END
+i=$((i + 1))
+done
+echo "int main()"
+echo "{"
+echo "    int arr[4];"
+echo "    int k = 0, r = 0;"
+echo "    while(k < 4)"
+echo "    {"
+echo "        arr[k] = read();"
+echo "        k = k + 1;"
+echo "    }"
+i=0
+while [ $i -lt $n ]; do
+echo "    r = r + f$i(arr, $i);"
+i=$((i + 1))
+done
+echo "    write(r);"
+echo "    return 0;"
+echo "}"
@@ -0,0 +1,305 @@
+/*
+ * Number of inter codes a C-- program executes, without and with -O.
+ *  make bench-opt
+ * or
+ *  g++ -O2 -I../Code irexec.cpp ../Code/libcmm.a -pthread -o irexec
+ *  ./irexec source [inputs...]
+ * The inter codes are run by a small interpreter, read() returns the inputs in order, then 0.
+ * Prints what the program writes and the number of codes executed each way, with the reduction.
+ * Codes are counted rather than MIPS32 instructions, most codes are translated to a few instructions and
+ * a store, so the reduction of codes is close to that of instructions.
+ */
+#include "Compiler.h"
+#include "SourceBuffer.h"
+#include <sstream>
+#include <unordered_map>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define STEP_LIMIT 100000000
+
+// codes of a function
+struct Body
+{
+    vector<vector<string> > codes;      // tokens of each code
+    unordered_map<string, int> labels;  // label -> index of its code
+};
+
+class Interpreter
+{
+private:
+    unordered_map<string, Body> functions;
+    vector<int> memory;     // words, addresses are in bytes
+    vector<int> inputs;
+    size_t nextInput;
+
+    typedef unordered_map<string, int> Frame;  // variable or temp -> address
+
+    int allocate(int size)
+    {
+        int address = memory.size() * 4;
+        memory.resize(memory.size() + (size + 3) / 4, 0);
+        return address;
+    }
+    int address(Frame& frame, const string& name)
+    {
+        Frame::iterator it = frame.find(name);
+        if(it == frame.end())
+        {
+            it = frame.insert(make_pair(name, allocate(4))).first;
+        }
+        return it->second;
+    }
+    int load(int address)
+    {
+        if(address < 0 || address / 4 >= (int)memory.size())
+        {
+            throw string("bad address");
+        }
+        return memory[address / 4];
+    }
+    int value(Frame& frame, const string& operand)
+    {
+        switch(operand[0])
+        {
+            case '#': return atoi(operand.c_str() + 1);
+            case '&': return address(frame, operand.substr(1));
+            case '*': return load(value(frame, operand.substr(1)));
+            default: return load(address(frame, operand));
+        }
+    }
+    void store(Frame& frame, const string& operand, long long v)
+    {
+        int address = operand[0] == '*' ? value(frame, operand.substr(1)) : this->address(frame, operand);
+        load(address);
+        memory[address / 4] = (int)(unsigned int)v;
+    }
+    static bool compare(int x, const string& relop, int y)
+    {
+        if(relop == "==") return x == y;
+        if(relop == "!=") return x != y;
+        if(relop == "<") return x < y;
+        if(relop == "<=") return x <= y;
+        if(relop == ">") return x > y;
+        return x >= y;
+    }
+    int call(const string& name, const vector<int>& args);
+public:
+    vector<int> writes;
+    long long steps;
+
+    void load(const string& interCodes);
+    /*
+     * Run main(), writes and steps tell what it did.
+     * @return
+     *  "" if it has returned, or what went wrong.
+     */
+    string run(const vector<int>& inputs);
+};
+
+void Interpreter::load(const string& interCodes)
+{
+    istringstream in(interCodes);
+    string line;
+    Body *function = NULL;
+    while(getline(in, line))
+    {
+        istringstream words(line);
+        vector<string> tokens;
+        string token;
+        while(words >> token)
+        {
+            tokens.push_back(token);
+        }
+        if(tokens.empty())
+        {
+            continue;
+        }
+        if(tokens[0] == "FUNCTION")
+        {
+            function = &functions[tokens[1]];
+            continue;
+        }
+        if(function == NULL)
+        {
+            continue;
+        }
+        if(tokens[0] == "LABEL")
+        {
+            function->labels[tokens[1]] = function->codes.size();
+        }
+        function->codes.push_back(tokens);
+    }
+}
+
+int Interpreter::call(const string& name, const vector<int>& args)
+{
+    Body &function = functions[name];
+    Frame frame;
+    vector<int> pending;    // ARGs, the last arg first
+    int paramIndex = 0;
+    int pc = 0;
+    while(pc < (int)function.codes.size())
+    {
+        if(++ steps > STEP_LIMIT)
+        {
+            throw string("step limit");
+        }
+        const vector<string> &code = function.codes[pc ++];
+        const string &op = code[0];
+        if(op == "LABEL")
+        {
+            continue;
+        }
+        else if(op == "GOTO")
+        {
+            pc = function.labels[code[1]];
+        }
+        else if(op == "IF")
+        {
+            if(compare(value(frame, code[1]), code[2], value(frame, code[3])))
+            {
+                pc = function.labels[code[5]];
+            }
+        }
+        else if(op == "RETURN")
+        {
+            return value(frame, code[1]);
+        }
+        else if(op == "PARAM")
+        {
+            store(frame, code[1], paramIndex < (int)args.size() ? args[paramIndex] : 0);
+            paramIndex ++;
+        }
+        else if(op == "DEC")
+        {
+            frame[code[1]] = allocate(atoi(code[2].c_str()));
+        }
+        else if(op == "ARG")
+        {
+            pending.push_back(value(frame, code[1]));
+        }
+        else if(op == "READ")
+        {
+            store(frame, code[1], nextInput < inputs.size() ? inputs[nextInput ++] : 0);
+        }
+        else if(op == "WRITE")
+        {
+            writes.push_back(value(frame, code[1]));
+        }
+        else if(code.size() >= 4 && code[2] == "CALL")
+        {
+            vector<int> callArgs(pending.rbegin(), pending.rend());
+            pending.clear();
+            store(frame, code[0], call(code[3], callArgs));
+        }
+        else if(code.size() == 3)
+        {
+            store(frame, code[0], value(frame, code[2]));
+        }
+        else if(code.size() == 5)
+        {
+            long long x = value(frame, code[2]), y = value(frame, code[4]);
+            switch(code[3][0])
+            {
+                case '+': store(frame, code[0], x + y); break;
+                case '-': store(frame, code[0], x - y); break;
+                case '*': store(frame, code[0], x * y); break;
+                default:
+                    if(y == 0)
+                    {
+                        throw string("division by zero");
+                    }
+                    store(frame, code[0], x / y);
+                    break;
+            }
+        }
+        else
+        {
+            throw "unknown code: " + op;
+        }
+    }
+    throw "no RETURN in " + name;
+}
+
+string Interpreter::run(const vector<int>& inputs)
+{
+    this->inputs = inputs;
+    nextInput = 0;
+    memory.clear();
+    writes.clear();
+    steps = 0;
+    try
+    {
+        call("main", vector<int>());
+    }
+    catch(string error)
+    {
+        return error;
+    }
+    return "";
+}
+
+static bool interCodes(const char *sourceFile, bool optimize, string *codes)
+{
+    SourceBuffer source;
+    if(!source.open(sourceFile))
+    {
+        return false;
+    }
+    ostringstream diagnostics, ir;
+    Compiler compiler(&diagnostics);
+    compiler.setOptimize(optimize);
+    if(!compiler.compile(&source, &ir, NULL))
+    {
+        fprintf(stderr, "%s", diagnostics.str().c_str());
+        return false;
+    }
+    *codes = ir.str();
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s source [inputs...]\n", argv[0]);
+        return 1;
+    }
+    vector<int> inputs;
+    for(int i = 2; i < argc; i ++)
+    {
+        inputs.push_back(atoi(argv[i]));
+    }
+    Interpreter interpreters[2];
+    for(int o = 0; o < 2; o ++)
+    {
+        string codes;
+        if(!interCodes(argv[1], o == 1, &codes))
+        {
+            fprintf(stderr, "%s: can't compile\n", argv[1]);
+            return 1;
+        }
+        interpreters[o].load(codes);
+        string error = interpreters[o].run(inputs);
+        if(error != "")
+        {
+            fprintf(stderr, "%s%s: %s\n", argv[1], o == 1 ? " -O" : "", error.c_str());
+            return 1;
+        }
+    }
+    string writes;
+    for(int i = 0; i < (int)interpreters[0].writes.size(); i ++)
+    {
+        writes += " " + to_string(interpreters[0].writes[i]);
+    }
+    long long before = interpreters[0].steps, after = interpreters[1].steps;
+    printf("%-24s %8lld -> %8lld codes  %6.1f%%   writes%s\n", argv[1], before, after,
+            before == 0 ? 0.0 : 100.0 * (after - before) / before, writes.c_str());
+    if(interpreters[0].writes != interpreters[1].writes)
+    {
+        printf("%s: -O writes something else\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * Microbenchmark of SymbolTable against the chained table of the original tree (LegacySymbolTable below).
+ *  make bench-symtab
+ * or
+ *  g++ -O2 -I../Code symtab_bench.cpp ../Code/SymbolTable.cpp ../Code/TypeContext.cpp ../Code/Region.cpp ../Code/Interner.cpp -o symtab_bench
+ *  ./symtab_bench [number of symbols]
+ * Three workloads, each timed as ns per operation:
+ *  insert      add all the symbols to the outmost scope
+ *  lookup      look up random symbols, a quarter of which have not been added
+ *  scope-exit  enter a scope, shadow some symbols, look them up and exit, over and over
+ */
+#include "SymbolTable.h"
+#include <chrono>
+#include <stdlib.h>
+#include <stdio.h>
+
+/*
+ * The table of the original tree: 16384 chained buckets indexed by hashPJW over the name,
+ * individually new-ed items told apart by comparing names, and a full scan of the buckets
+ * on every scope exit.
+ */
+#define LEGACY_HASH_SIZE 16384
+class LegacySymbolTable
+{
+private:
+    TableItem *hashTable[LEGACY_HASH_SIZE];
+    int scopeDepth;
+
+    static unsigned int hashPJW(const char *name)
+    {
+        unsigned int val = 0, i;
+        for(; *name; ++ name)
+        {
+            val = (val << 2) + *name;
+            if((i = val & ~0x3fff))
+            {
+                val = (val ^ (i >> 12)) & 0x3fff;
+            }
+        }
+        return val;
+    }
+public:
+    LegacySymbolTable()
+    {
+        for(int i = 0; i < LEGACY_HASH_SIZE; i ++)
+        {
+            hashTable[i] = NULL;
+        }
+        scopeDepth = 0;
+    }
+    ~LegacySymbolTable(){ clearTable();}
+    void clearTable()
+    {
+        for(int i = 0; i < LEGACY_HASH_SIZE; i ++)
+        {
+            TableItem *p = hashTable[i];
+            while(p)
+            {
+                TableItem *tmp = p;
+                p = p->next;
+                delete tmp;
+            }
+            hashTable[i] = NULL;
+        }
+        scopeDepth = 0;
+    }
+    void addFieldList(FieldList fieldList)
+    {
+        TableItem *item = new TableItem();
+        item->name = fieldList->name;
+        item->type = fieldList->type;
+        item->isPointer = false;
+        item->depth = scopeDepth;
+        int hashValue = hashPJW(item->name.c_str());
+        item->next = hashTable[hashValue];
+        hashTable[hashValue] = item;
+    }
+    TableItem* getItemByName(string name)
+    {
+        TableItem *p = hashTable[hashPJW(name.c_str())];
+        while(p && p->name.compare(name) != 0)
+        {
+            p = p->next;
+        }
+        return p;
+    }
+    void enterScope(){ scopeDepth ++;}
+    void exitScope()
+    {
+        for(int i = 0; i < LEGACY_HASH_SIZE; i ++)
+        {
+            TableItem *t = hashTable[i];
+            while(t && t->depth >= scopeDepth)
+            {
+                TableItem *tmp = t;
+                t = t->next;
+                delete tmp;
+            }
+            hashTable[i] = t;
+        }
+        scopeDepth --;
+    }
+};
+
+// the old table looks up names, the current one interned symbols
+static TableItem* lookUp(LegacySymbolTable *table, FieldList field){ return table->getItemByName(field->name);}
+static TableItem* lookUp(SymbolTable *table, FieldList field){ return table->getItemBySymbol(field->symbol);}
+
+#define SCOPE_NUM 2000
+#define SHADOWED_PER_SCOPE 8
+
+static double nsPerOp(chrono::steady_clock::time_point begin, long ops)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / ops;
+}
+
+template<class Table>
+static void run(const char *name, Table *table, vector<FieldList> &fields, vector<FieldList> &probes)
+{
+    int n = fields.size();
+    long found = 0;
+    table->clearTable();
+
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    for(int i = 0; i < n; i ++)
+    {
+        table->addFieldList(fields[i]);
+    }
+    double insert = nsPerOp(begin, n);
+
+    begin = chrono::steady_clock::now();
+    for(int i = 0; i < (int)probes.size(); i ++)
+    {
+        found += lookUp(table, probes[i]) != NULL;
+    }
+    double lookup = nsPerOp(begin, probes.size());
+
+    begin = chrono::steady_clock::now();
+    for(int s = 0; s < SCOPE_NUM; s ++)
+    {
+        table->enterScope();
+        for(int i = 0; i < SHADOWED_PER_SCOPE; i ++)
+        {
+            table->addFieldList(fields[(s * SHADOWED_PER_SCOPE + i) % n]);
+        }
+        for(int i = 0; i < SHADOWED_PER_SCOPE; i ++)
+        {
+            found += lookUp(table, fields[(s * SHADOWED_PER_SCOPE + i) % n]) != NULL;
+        }
+        table->exitScope();
+    }
+    double scopeExit = nsPerOp(begin, SCOPE_NUM);
+
+    printf("%-8s insert %8.1f  lookup %8.1f  scope-exit %10.1f  (found %ld)\n", name, insert, lookup, scopeExit, found);
+}
+
+static FieldList newField(Interner *interner, string name, Type type)
+{
+    FieldList field = new FieldList_();
+    field->name = name;
+    field->symbol = interner->intern(name);
+    field->type = type;
+    field->tail = NULL;
+    return field;
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 50000;
+    Interner interner;
+    TypeContext typeContext;
+    Type type = typeContext.getBasicType(INT);
+    vector<FieldList> fields;
+    for(int i = 0; i < n; i ++)
+    {
+        fields.push_back(newField(&interner, "v" + to_string(i), type));
+    }
+    // symbols that are interned but never added, as identifiers only used in undefined references would be
+    int missNum = n / 3 + 1;
+    vector<FieldList> misses;
+    for(int i = 0; i < missNum; i ++)
+    {
+        misses.push_back(newField(&interner, "u" + to_string(i), type));
+    }
+    vector<FieldList> probes;
+    srand(1);
+    for(int i = 0; i < n * 10; i ++)
+    {
+        probes.push_back(rand() % 4 == 0 ? misses[rand() % missNum] : fields[rand() % n]);
+    }
+
+    printf("%d symbols, ns per operation\n", n);
+    LegacySymbolTable *legacy = new LegacySymbolTable();
+    run("legacy", legacy, fields, probes);
+    delete legacy;
+    SymbolTable *table = new SymbolTable();
+    run("current", table, fields, probes);
+    delete table;
+    return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * Count C++ exceptions thrown by a process.
+ * Build as a shared library and load it with LD_PRELOAD,
+ * the number of throws is printed to stderr when the process exits.
+ *  g++ -shared -fPIC throwcount.cpp -o throwcount.so -ldl
+ *  LD_PRELOAD=./throwcount.so ./parser large.cmm
+ */
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef void (*CxaThrow)(void*, void*, void (*)(void*));
+
+static unsigned long throwCount = 0;
+
+static void report()
+{
+    fprintf(stderr, "C++ exceptions thrown: %lu\n", throwCount);
+}
+
+extern "C" void __cxa_throw(void* exception, void* typeInfo, void (*destructor)(void*))
+{
+    static CxaThrow realThrow = NULL;
+    if(realThrow == NULL)
+    {
+        realThrow = (CxaThrow)dlsym(RTLD_NEXT, "__cxa_throw");
+    }
+    throwCount ++;
+    realThrow(exception, typeInfo, destructor);
+    abort();    // __cxa_throw never returns
+}
+
+__attribute__((constructor)) static void init()
+{
+    atexit(report);
+}
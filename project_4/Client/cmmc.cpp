@@ -0,0 +1,164 @@
+/*
+ * Client of the compile server, used in place of parser:
+ *  cmmc [-s socket] [-i irFile] source [output]
+ * The source is sent to a server started by "parser -S socket",
+ * diagnostics are printed to stdout, MIPS32 code goes to output or stdout.
+ * Exit status is 0 on success, 1 on compile errors, 2 if the server can't be reached.
+ */
+#include "CompileProtocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+using namespace std;
+
+static bool readFile(const char *path, vector<char>& content)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+    char buffer[65536];
+    ssize_t n;
+    while((n = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        content.insert(content.end(), buffer, buffer + n);
+    }
+    close(fd);
+    return n == 0;
+}
+
+static bool writeFile(const char *path, const string& content)
+{
+    FILE *f = fopen(path, "w");
+    if(f == NULL)
+    {
+        return false;
+    }
+    fwrite(content.data(), 1, content.size(), f);
+    return fclose(f) == 0;
+}
+
+static int connectServer(const char *socketPath)
+{
+    struct sockaddr_un address;
+    if(strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+    if(connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool readString(int fd, uint32_t length, string& s)
+{
+    s.resize(length);
+    return length == 0 || readFully(fd, &s[0], length);
+}
+
+int main(int argc, char** argv)
+{
+    const char *socketPath = DEFAULT_SOCKET_PATH;
+    const char *irFile = NULL;
+    int opt;
+    while((opt = getopt(argc, argv, "s:i:")) != -1)
+    {
+        switch(opt)
+        {
+            case 's':
+                socketPath = optarg;
+                break;
+            case 'i':
+                irFile = optarg;
+                break;
+            default:
+                return 2;
+        }
+    }
+    if(optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-s socket] [-i irFile] source [output]\n", argv[0]);
+        return 2;
+    }
+    const char *sourceFile = argv[optind];
+    const char *asmFile = optind + 1 < argc ? argv[optind + 1] : NULL;
+
+    vector<char> source;
+    if(!readFile(sourceFile, source))
+    {
+        perror(sourceFile);
+        return 1;
+    }
+    if(source.size() > MAX_SOURCE_LENGTH)
+    {
+        fprintf(stderr, "%s: too large\n", sourceFile);
+        return 1;
+    }
+    int fd = connectServer(socketPath);
+    if(fd < 0)
+    {
+        perror(socketPath);
+        return 2;
+    }
+
+    CompileRequestHeader request;
+    request.flags = htonl(REQUEST_WANT_ASM | (irFile != NULL ? REQUEST_WANT_IR : 0));
+    request.sourceLength = htonl(source.size());
+    CompileResponseHeader response;
+    string diagnostics, ir, mips;
+    if(!writeFully(fd, &request, sizeof(request))
+        || !writeFully(fd, source.data(), source.size())
+        || !readFully(fd, &response, sizeof(response))
+        || !readString(fd, ntohl(response.diagnosticsLength), diagnostics)
+        || !readString(fd, ntohl(response.irLength), ir)
+        || !readString(fd, ntohl(response.asmLength), mips))
+    {
+        fprintf(stderr, "%s: connection to compile server lost\n", socketPath);
+        close(fd);
+        return 2;
+    }
+    close(fd);
+
+    fwrite(diagnostics.data(), 1, diagnostics.size(), stdout);
+    if(!ntohl(response.succeeded))
+    {
+        return 1;
+    }
+    if(irFile != NULL && !writeFile(irFile, ir))
+    {
+        perror(irFile);
+        return 1;
+    }
+    if(asmFile != NULL)
+    {
+        if(!writeFile(asmFile, mips))
+        {
+            perror(asmFile);
+            return 1;
+        }
+    }
+    else
+    {
+        fwrite(mips.data(), 1, mips.size(), stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#ifndef _BITSET_H
+#define _BITSET_H
+
+#include "common.h"
+#include <vector>
+#include <stdint.h>
+
+/*
+ * Set of the numbers 0 .. size()-1, one bit each, 64 to a word.
+ * Sets combined by unionWith() and the others should have the same size.
+ * Bits beyond size() in the last word are always 0, so sets can be compared and counted by words.
+ */
+class BitSet
+{
+private:
+    vector<uint64_t> words;
+    int bitNum;
+
+    void clearTail()
+    {
+        if(bitNum % 64 != 0)
+        {
+            words.back() &= ((uint64_t)1 << (bitNum % 64)) - 1;
+        }
+    }
+public:
+    BitSet(){ bitNum = 0;}
+    BitSet(int bitNum, bool value = false)
+    {
+        this->bitNum = bitNum;
+        words.assign((bitNum + 63) / 64, value ? ~(uint64_t)0 : 0);
+        clearTail();
+    }
+
+    int size() const { return bitNum;}
+    bool test(int i) const { return (words[i / 64] >> (i % 64)) & 1;}
+    void set(int i){ words[i / 64] |= (uint64_t)1 << (i % 64);}
+    void reset(int i){ words[i / 64] &= ~((uint64_t)1 << (i % 64));}
+    void setAll(bool value)
+    {
+        for(int w = 0; w < (int)words.size(); w ++)
+        {
+            words[w] = value ? ~(uint64_t)0 : 0;
+        }
+        clearTail();
+    }
+    /*
+     * @return
+     *  Whether any bit has been added.
+     */
+    bool unionWith(const BitSet& other)
+    {
+        uint64_t changed = 0;
+        for(int w = 0; w < (int)words.size(); w ++)
+        {
+            changed |= other.words[w] & ~words[w];
+            words[w] |= other.words[w];
+        }
+        return changed != 0;
+    }
+    void intersectWith(const BitSet& other)
+    {
+        for(int w = 0; w < (int)words.size(); w ++)
+        {
+            words[w] &= other.words[w];
+        }
+    }
+    void subtract(const BitSet& other)
+    {
+        for(int w = 0; w < (int)words.size(); w ++)
+        {
+            words[w] &= ~other.words[w];
+        }
+    }
+    /*
+     * this = gen | (in & ~kill), the transfer function of a block.
+     * @return
+     *  Whether the set has changed.
+     */
+    bool transfer(const BitSet& gen, const BitSet& in, const BitSet& kill)
+    {
+        uint64_t changed = 0;
+        for(int w = 0; w < (int)words.size(); w ++)
+        {
+            uint64_t word = gen.words[w] | (in.words[w] & ~kill.words[w]);
+            changed |= word ^ words[w];
+            words[w] = word;
+        }
+        return changed != 0;
+    }
+    bool operator==(const BitSet& other) const { return bitNum == other.bitNum && words == other.words;}
+    bool operator!=(const BitSet& other) const { return !(*this == other);}
+    int count() const
+    {
+        int n = 0;
+        for(int w = 0; w < (int)words.size(); w ++)
+        {
+            n += __builtin_popcountll(words[w]);
+        }
+        return n;
+    }
+    /*
+     * Smallest number in the set that is >= from, -1 if there's none.
+     * for(int i = set.next(0); i != -1; i = set.next(i + 1)) visits the set in order.
+     */
+    int next(int from) const
+    {
+        if(from >= bitNum)
+        {
+            return -1;
+        }
+        int w = from / 64;
+        uint64_t word = words[w] & (~(uint64_t)0 << (from % 64));
+        while(word == 0)
+        {
+            if(++ w == (int)words.size())
+            {
+                return -1;
+            }
+            word = words[w];
+        }
+        return w * 64 + __builtin_ctzll(word);
+    }
+};
+
+#endif
@@ -0,0 +1,293 @@
+#include "CFG.h"
+#include <algorithm>
+
+CFG::CFG()
+{
+    this->unit = NULL;
+    this->entry = 0;
+    this->exit = 0;
+}
+
+void CFG::addEdge(int from, int to)
+{
+    vector<int> &succs = blocks[from].succs;
+    if(find(succs.begin(), succs.end(), to) != succs.end())
+    {
+        // IF ... GOTO to the label right after it
+        return;
+    }
+    succs.push_back(to);
+    blocks[to].preds.push_back(from);
+}
+
+void CFG::build(const IRCodes& unit)
+{
+    this->unit = &unit;
+    blocks.clear();
+    labelBlocks.clear();
+
+    // find the first code of each block
+    const vector<InterCode_> &codes = unit.codes;
+    int codeNum = codes.size();
+    vector<bool> isLeader(codeNum + 1, false);
+    isLeader[0] = true;
+    for(int i = 0; i < codeNum; i ++)
+    {
+        switch(codes[i].kind)
+        {
+            case LABEL_DEC:
+                isLeader[i] = true;
+                break;
+            case GOTO:case COND_GOTO:case RETURN:
+                isLeader[i + 1] = true;
+                break;
+            default: break;
+        }
+    }
+    for(int i = 0; i < codeNum; i ++)
+    {
+        if(!isLeader[i])
+        {
+            continue;
+        }
+        int end = i + 1;
+        while(end < codeNum && !isLeader[end])
+        {
+            end ++;
+        }
+        if(codes[i].kind == LABEL_DEC)
+        {
+            labelBlocks[codes[i].u.sinop.op.index()] = blocks.size();
+        }
+        blocks.push_back(BasicBlock(i, end));
+    }
+    entry = 0;
+    exit = blocks.size();
+    blocks.push_back(BasicBlock(codeNum, codeNum));
+
+    // edges, the exit block has none
+    for(int b = 0; b < exit; b ++)
+    {
+        const InterCode_ &last = codes[blocks[b].end - 1];
+        int target;
+        switch(last.kind)
+        {
+            case GOTO:
+                target = getLabelBlock(last.u.sinop.op);
+                if(target != -1)
+                {
+                    addEdge(b, target);
+                }
+                break;
+            case COND_GOTO:
+                addEdge(b, b + 1);
+                target = getLabelBlock(last.u.condGoto->label);
+                if(target != -1)
+                {
+                    addEdge(b, target);
+                }
+                break;
+            case RETURN:
+                addEdge(b, exit);
+                break;
+            default:
+                addEdge(b, b + 1);
+                break;
+        }
+    }
+}
+
+int CFG::getLabelBlock(Operand label) const
+{
+    unordered_map<int, int>::const_iterator it = labelBlocks.find(label.index());
+    return it == labelBlocks.end() ? -1 : it->second;
+}
+
+/*
+ * Depth first search from the entry, a block is put after all the succs it goes to.
+ */
+vector<int> CFG::getPostorder() const
+{
+    vector<int> order;
+    vector<bool> visited(blocks.size(), false);
+    vector<pair<int, int> > stack;  // block, next succ to visit
+    stack.push_back(make_pair(entry, 0));
+    visited[entry] = true;
+    while(!stack.empty())
+    {
+        int block = stack.back().first;
+        const vector<int> &succs = blocks[block].succs;
+        if(stack.back().second < (int)succs.size())
+        {
+            int succ = succs[stack.back().second ++];
+            if(!visited[succ])
+            {
+                visited[succ] = true;
+                stack.push_back(make_pair(succ, 0));
+            }
+            continue;
+        }
+        order.push_back(block);
+        stack.pop_back();
+    }
+    return order;
+}
+
+/*
+ * B1 <- B0 -> B2 B3
+ *     codes of B1
+ */
+void CFG::dump(ostream& out) const
+{
+    for(int b = 0; b < (int)blocks.size(); b ++)
+    {
+        const BasicBlock &block = blocks[b];
+        out << "B" << b;
+        if(b == exit)
+        {
+            out << " exit";
+        }
+        if(!block.preds.empty())
+        {
+            out << " <-";
+            for(int i = 0; i < (int)block.preds.size(); i ++)
+            {
+                out << " B" << block.preds[i];
+            }
+        }
+        if(!block.succs.empty())
+        {
+            out << " ->";
+            for(int i = 0; i < (int)block.succs.size(); i ++)
+            {
+                out << " B" << block.succs[i];
+            }
+        }
+        out << endl;
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            if(unit->codes[i].kind != NOP)
+            {
+                out << "    " << InterCodeTranslater::toString(&unit->codes[i], *unit) << endl;
+            }
+        }
+    }
+}
+
+/*
+ * Graph of each unit of the program, each followed by a blank line.
+ */
+void CFG::dump(const IRProgram& program, ostream& out)
+{
+    CFG cfg;
+    for(int i = 0; i < (int)program.size(); i ++)
+    {
+        cfg.build(program[i]);
+        cfg.dump(out);
+        out << endl;
+    }
+}
+
+/**************************** Dominators ***************************/
+/*
+ * Nearest common dominator of a and b, walking up the tree from the one later in reverse postorder.
+ */
+int Dominators::intersect(int a, int b) const
+{
+    while(a != b)
+    {
+        while(orderIndexes[a] > orderIndexes[b])
+        {
+            a = idoms[a];
+        }
+        while(orderIndexes[b] > orderIndexes[a])
+        {
+            b = idoms[b];
+        }
+    }
+    return a;
+}
+
+/*
+ * The idom of a block is the intersection of its preds' ones, visited in reverse postorder until nothing changes,
+ * which takes few passes since most preds are visited before the block.
+ * A join block is in the frontier of each block from its preds up to, but not including, its idom.
+ */
+void Dominators::build(const CFG& cfg)
+{
+    int blockNum = cfg.getBlockNum();
+    order = cfg.getPostorder();
+    reverse(order.begin(), order.end());
+    orderIndexes.assign(blockNum, -1);
+    for(int i = 0; i < (int)order.size(); i ++)
+    {
+        orderIndexes[order[i]] = i;
+    }
+
+    int entry = cfg.getEntry();
+    idoms.assign(blockNum, -1);
+    idoms[entry] = entry;   // for intersect() to stop at, -1 once done
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        for(int i = 1; i < (int)order.size(); i ++)
+        {
+            int block = order[i];
+            const vector<int> &preds = cfg.getBlock(block).preds;
+            int idom = -1;
+            for(int j = 0; j < (int)preds.size(); j ++)
+            {
+                if(idoms[preds[j]] == -1)
+                {
+                    // not visited yet, or unreachable
+                    continue;
+                }
+                idom = idom == -1 ? preds[j] : intersect(preds[j], idom);
+            }
+            if(idoms[block] != idom)
+            {
+                idoms[block] = idom;
+                changed = true;
+            }
+        }
+    }
+
+    children.assign(blockNum, vector<int>());
+    frontiers.assign(blockNum, vector<int>());
+    for(int i = 1; i < (int)order.size(); i ++)
+    {
+        int block = order[i];
+        children[idoms[block]].push_back(block);
+        const vector<int> &preds = cfg.getBlock(block).preds;
+        if(preds.size() < 2)
+        {
+            continue;
+        }
+        for(int j = 0; j < (int)preds.size(); j ++)
+        {
+            for(int runner = preds[j]; isReachable(runner) && runner != idoms[block]; runner = idoms[runner])
+            {
+                vector<int> &frontier = frontiers[runner];
+                if(frontier.empty() || frontier.back() != block)
+                {
+                    frontier.push_back(block);
+                }
+            }
+        }
+    }
+    idoms[entry] = -1;
+}
+
+bool Dominators::dominates(int a, int b) const
+{
+    if(!isReachable(a) || !isReachable(b))
+    {
+        return false;
+    }
+    while(b != -1 && b != a)
+    {
+        b = idoms[b];
+    }
+    return b == a;
+}
@@ -0,0 +1,94 @@
+#ifndef _CFG_H
+#define _CFG_H
+
+#include "common.h"
+#include <vector>
+#include <unordered_map>
+#include "InterCode.h"
+
+/*
+ * A run of codes that is only entered at its first code and only left after its last one.
+ */
+struct BasicBlock
+{
+    int begin, end;         // codes [begin, end) of the unit
+    vector<int> succs;      // blocks control may go to next, the fall through one first
+    vector<int> preds;      // blocks control may come from
+
+    BasicBlock(int begin, int end)
+    {
+        this->begin = begin;
+        this->end = end;
+    }
+};
+
+/*
+ * Control flow graph of the codes of one IRCodes, i.e. of one function.
+ * A block starts at the first code, at a LABEL and after a GOTO, IF ... GOTO or RETURN.
+ * Blocks are in the order of their codes, followed by an empty exit block that RETURNs go to,
+ * so every path from the entry ends at the exit. Blocks nothing jumps or falls to are kept, without preds.
+ * A jump to a label that isn't in the unit has no edge.
+ * The graph describes the codes as they were when it was built, build it again after codes are added or removed.
+ */
+class CFG
+{
+private:
+    const IRCodes *unit;
+    vector<BasicBlock> blocks;
+    int entry, exit;
+    unordered_map<int, int> labelBlocks;    // label number -> block it starts
+
+    void addEdge(int from, int to);
+public:
+    CFG();
+    void build(const IRCodes& unit);
+
+    const IRCodes& getUnit() const { return *unit;}
+    int getBlockNum() const { return blocks.size();}
+    const BasicBlock& getBlock(int index) const { return blocks[index];}
+    int getEntry() const { return entry;}
+    int getExit() const { return exit;}
+    /*
+     * @return
+     *  Block that starts with LABEL label, -1 if there's no such label in the unit.
+     */
+    int getLabelBlock(Operand label) const;
+    /*
+     * Blocks reachable from the entry, each after the blocks it leads to, but for those that loop back to it.
+     * Reversed, a block comes after all its preds but loops' ones.
+     */
+    vector<int> getPostorder() const;
+    /*
+     * Codes of each block, with the edges of the block, for inspection.
+     */
+    void dump(ostream& out) const;
+    static void dump(const IRProgram& program, ostream& out);
+};
+
+/*
+ * Dominator tree of a CFG, by the iterative algorithm of Cooper, Harvey and Kennedy, and dominance frontiers.
+ * a dominates b if every path from the entry to b goes through a, the idom of b is the nearest block that strictly does.
+ * The frontier of a is where its dominance ends: blocks a doesn't strictly dominate, with a pred a dominates.
+ * Blocks unreachable from the entry are left out of the tree and the frontiers.
+ */
+class Dominators
+{
+private:
+    vector<int> order;          // reachable blocks in reverse postorder
+    vector<int> orderIndexes;   // block -> its position in order, -1 if unreachable
+    vector<int> idoms;          // -1 for the entry and unreachable blocks
+    vector<vector<int> > children;
+    vector<vector<int> > frontiers;
+
+    int intersect(int a, int b) const;
+public:
+    void build(const CFG& cfg);
+    bool isReachable(int block) const { return orderIndexes[block] != -1;}
+    int getIdom(int block) const { return idoms[block];}
+    const vector<int>& getChildren(int block) const { return children[block];}
+    const vector<int>& getFrontier(int block) const { return frontiers[block];}
+    const vector<int>& getReversePostorder() const { return order;}
+    bool dominates(int a, int b) const;
+};
+
+#endif
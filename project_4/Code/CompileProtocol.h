@@ -0,0 +1,81 @@
+#ifndef _COMPILEPROTOCOL_H
+#define _COMPILEPROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+
+/*
+ * Messages between the compile server (parser -S) and its clients, over a Unix domain socket.
+ * A connection carries any number of requests, each answered by one response, until the client closes it.
+ * All integers are in network byte order.
+ *  request:    CompileRequestHeader, then the source
+ *  response:   CompileResponseHeader, then diagnostics, inter codes and MIPS32 code, one after another
+ */
+#define DEFAULT_SOCKET_PATH "/tmp/cmm-compiler.sock"
+#define MAX_SOURCE_LENGTH (64 << 20)
+
+// request flags
+#define REQUEST_WANT_IR 1
+#define REQUEST_WANT_ASM 2
+
+struct CompileRequestHeader
+{
+    uint32_t flags;
+    uint32_t sourceLength;
+};
+
+struct CompileResponseHeader
+{
+    uint32_t succeeded;     // 1 if there's no error
+    uint32_t diagnosticsLength;
+    uint32_t irLength;
+    uint32_t asmLength;
+};
+
+/*
+ * Read or write exactly 'size' bytes.
+ * Return false on error or end of file.
+ */
+inline bool readFully(int fd, void* buffer, size_t size)
+{
+    char *p = (char*)buffer;
+    while(size > 0)
+    {
+        ssize_t n = read(fd, p, size);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+inline bool writeFully(int fd, const void* buffer, size_t size)
+{
+    const char *p = (const char*)buffer;
+    while(size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include "CompileServer.h"
+#include "CompileProtocol.h"
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+CompileServer::CompileServer(string socketPath, int workerNum)
+{
+    this->socketPath = socketPath;
+    this->workerNum = workerNum > 0 ? workerNum : 1;
+    this->listenFd = -1;
+}
+
+CompileServer::~CompileServer()
+{
+    if(listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+/*
+ * Bind and listen on the socket, a stale socket file left by a previous server is removed.
+ * @return
+ *  false on error, errno is set.
+ */
+bool CompileServer::start()
+{
+    struct sockaddr_un address;
+    if(socketPath.size() >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    // a client going away in the middle of a response shouldn't kill the server
+    signal(SIGPIPE, SIG_IGN);
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listenFd < 0)
+    {
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath.c_str());
+    unlink(socketPath.c_str());
+    if(bind(listenFd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, 64) < 0)
+    {
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Accept connections and hand them to the workers, until accept() fails.
+ */
+void CompileServer::run()
+{
+    vector<thread> workers;
+    for(int i = 0; i < workerNum; i ++)
+    {
+        workers.push_back(thread(&CompileServer::work, this));
+    }
+    while(true)
+    {
+        int fd = accept(listenFd, NULL, NULL);
+        if(fd < 0)
+        {
+            if(errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            break;
+        }
+        lock_guard<mutex> guard(connectionsLock);
+        connections.push(fd);
+        connectionsReady.notify_one();
+    }
+    // tell the workers to stop
+    {
+        lock_guard<mutex> guard(connectionsLock);
+        for(int i = 0; i < workerNum; i ++)
+        {
+            connections.push(-1);
+        }
+        connectionsReady.notify_all();
+    }
+    for(int i = 0; i < (int)workers.size(); i ++)
+    {
+        workers[i].join();
+    }
+}
+
+void CompileServer::work()
+{
+    Compiler compiler(NULL);
+    while(true)
+    {
+        int fd;
+        {
+            unique_lock<mutex> guard(connectionsLock);
+            connectionsReady.wait(guard, [this](){ return !connections.empty();});
+            fd = connections.front();
+            connections.pop();
+        }
+        if(fd < 0)
+        {
+            return;
+        }
+        while(serveRequest(compiler, fd))
+            ;
+        close(fd);
+    }
+}
+
+/*
+ * Read one request from the connection, compile it and send the response back.
+ * The source is read straight into the buffer the scanner works on.
+ * @return
+ *  false if the connection is closed or broken.
+ */
+bool CompileServer::serveRequest(Compiler& compiler, int fd)
+{
+    CompileRequestHeader request;
+    if(!readFully(fd, &request, sizeof(request)))
+    {
+        return false;
+    }
+    uint32_t flags = ntohl(request.flags);
+    uint32_t sourceLength = ntohl(request.sourceLength);
+    if(sourceLength > MAX_SOURCE_LENGTH)
+    {
+        return false;
+    }
+    SourceBuffer source;
+    char *data = source.allocate(sourceLength);
+    if(data == NULL || !readFully(fd, data, sourceLength))
+    {
+        return false;
+    }
+
+    ostringstream diagnostics, ir, mips;
+    compiler.setDiagnostics(&diagnostics);
+    bool succeeded = compiler.compile(&source,
+                                      (flags & REQUEST_WANT_IR) ? &ir : NULL,
+                                      (flags & REQUEST_WANT_ASM) ? &mips : NULL);
+
+    string diagnosticsText = diagnostics.str(), irText = ir.str(), mipsText = mips.str();
+    CompileResponseHeader response;
+    response.succeeded = htonl(succeeded ? 1 : 0);
+    response.diagnosticsLength = htonl(diagnosticsText.size());
+    response.irLength = htonl(irText.size());
+    response.asmLength = htonl(mipsText.size());
+    return writeFully(fd, &response, sizeof(response))
+        && writeFully(fd, diagnosticsText.data(), diagnosticsText.size())
+        && writeFully(fd, irText.data(), irText.size())
+        && writeFully(fd, mipsText.data(), mipsText.size());
+}
@@ -0,0 +1,34 @@
+#ifndef _COMPILESERVER_H
+#define _COMPILESERVER_H
+
+#include "common.h"
+#include "Compiler.h"
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+
+/*
+ * A compiler daemon on a Unix domain socket, see CompileProtocol.h for the messages.
+ * Each worker thread owns a Compiler that stays warmed up between requests,
+ * and serves one connection at a time, so up to 'workerNum' clients are served at once.
+ */
+class CompileServer
+{
+private:
+    string socketPath;
+    int workerNum;
+    int listenFd;
+    queue<int> connections;     // accepted, waiting for a worker
+    mutex connectionsLock;
+    condition_variable connectionsReady;
+
+    void work();
+    bool serveRequest(Compiler& compiler, int fd);
+public:
+    CompileServer(string socketPath, int workerNum);
+    ~CompileServer();
+    bool start();
+    void run();
+};
+
+#endif
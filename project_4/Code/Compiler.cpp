@@ -0,0 +1,415 @@
+#include "Compiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <errno.h>
+#include <string.h>
+
+/*
+ * Compiles each ExtDef as soon as it's parsed, and writes out its codes.
+ */
+class StreamingHandler : public ExtDefHandler
+{
+private:
+    SemanticAnalyzer* semanticAnalyzer;
+    InterCodeTranslater* IRT;
+    MIPS32Translater* MT;
+    ostream* irOutput;
+    ostream* asmOutput;
+    bool dumpCFG;
+    bool optimize;
+public:
+    StreamingHandler(SemanticAnalyzer* semanticAnalyzer, InterCodeTranslater* IRT, MIPS32Translater* MT,
+                        ostream* irOutput, ostream* asmOutput, bool dumpCFG, bool optimize)
+    {
+        this->semanticAnalyzer = semanticAnalyzer;
+        this->IRT = IRT;
+        this->MT = MT;
+        this->irOutput = irOutput;
+        this->dumpCFG = dumpCFG;
+        this->optimize = optimize;
+        this->asmOutput = asmOutput;
+        IRT->reset();
+        MT->reset();
+        MT->translateHeadings();
+        if(asmOutput != NULL)
+        {
+            MT->output(*asmOutput);
+        }
+        MT->clearCodes();
+    }
+    void handleExtDef(Node* extDef)
+    {
+        semanticAnalyzer->analyseExtDef(extDef);
+        if(semanticAnalyzer->getSemanticErrorFlag() != NO_SEMANTIC_ERROR)
+        {
+            // keep on checking the rest, but there's no more output
+            return;
+        }
+        IRT->translateExtDef(extDef);
+        if(optimize)
+        {
+            IRT->optimize();
+        }
+        MT->translatePart(IRT->getProgram());
+        if(irOutput != NULL && dumpCFG)
+        {
+            CFG::dump(IRT->getProgram(), *irOutput);
+        }
+        else if(irOutput != NULL)
+        {
+            IRT->output(*irOutput);
+        }
+        if(asmOutput != NULL)
+        {
+            MT->output(*asmOutput);
+        }
+        MT->clearCodes();
+    }
+};
+
+Compiler::Compiler(ostream* diagnostics)
+{
+    this->diagnostics = diagnostics;
+    this->streaming = false;
+    this->dumpCFG = false;
+    this->optimize = false;
+    semanticAnalyzer.getSymbolTable()->setInterner(&parseContext.interner);
+}
+
+void Compiler::setDiagnostics(ostream* diagnostics)
+{
+    this->diagnostics = diagnostics;
+}
+
+void Compiler::setStreaming(bool streaming)
+{
+    this->streaming = streaming;
+}
+
+void Compiler::setDumpCFG(bool dumpCFG)
+{
+    this->dumpCFG = dumpCFG;
+}
+
+void Compiler::setOptimize(bool optimize)
+{
+    this->optimize = optimize;
+}
+
+void Compiler::outputIR(ostream& out)
+{
+    if(dumpCFG)
+    {
+        CFG::dump(interCodeTranslater.getProgram(), out);
+    }
+    else
+    {
+        interCodeTranslater.output(out);
+    }
+}
+
+bool Compiler::compileStreaming(SourceBuffer* source, ostream* irOutput, ostream* asmOutput)
+{
+    semanticAnalyzer.setDiagnostics(diagnostics);
+    semanticAnalyzer.beginAnalysis();
+    StreamingHandler handler(&semanticAnalyzer, &interCodeTranslater, &mips32Translater, irOutput, asmOutput, dumpCFG, optimize);
+    parseContext.diagnostics = diagnostics;
+    parseContext.extDefHandler = &handler;
+    parseContext.parse(source);
+    parseContext.extDefHandler = NULL;
+    if(parseContext.hasError())
+    {
+        return false;
+    }
+    semanticAnalyzer.endAnalysis();
+    return semanticAnalyzer.getSemanticErrorFlag() == NO_SEMANTIC_ERROR;
+}
+
+bool Compiler::compile(SourceBuffer* source, ostream* irOutput, ostream* asmOutput)
+{
+    if(streaming)
+    {
+        return compileStreaming(source, irOutput, asmOutput);
+    }
+    parseContext.diagnostics = diagnostics;
+    parseContext.parse(source);
+    if(parseContext.hasError())
+    {
+        return false;
+    }
+    Node* treeRoot = parseContext.treeRoot;
+#ifdef DEBUG
+    Node::printTree(treeRoot);
+#endif
+
+    semanticAnalyzer.setDiagnostics(diagnostics);
+    semanticAnalyzer.analyse(treeRoot);
+    if(semanticAnalyzer.getSemanticErrorFlag() != NO_SEMANTIC_ERROR)
+    {
+        return false;
+    }
+
+    interCodeTranslater.reset();
+    interCodeTranslater.translate(treeRoot);
+    if(optimize)
+    {
+        interCodeTranslater.optimize();
+    }
+    mips32Translater.reset();
+    mips32Translater.translate(interCodeTranslater.getProgram());
+    if(irOutput != NULL)
+    {
+        outputIR(*irOutput);
+    }
+    if(asmOutput != NULL)
+    {
+        mips32Translater.output(*asmOutput);
+    }
+    return true;
+}
+
+bool Compiler::compile(string sourceFile, string asmFile, string irFile)
+{
+    // token nodes point into the source, keep it until the tree is freed
+    SourceBuffer source;
+    if(!source.open(sourceFile.c_str()))
+    {
+        *diagnostics << sourceFile << ": " << strerror(errno) << endl;
+        return false;
+    }
+    if(streaming)
+    {
+        // write straight to the files, and remove them if there's an error
+        ofstream ir, mips;
+        if(irFile != "")
+        {
+            ir.open(irFile);
+        }
+        if(asmFile != "")
+        {
+            mips.open(asmFile);
+        }
+        bool succeeded = compile(&source, irFile != "" ? &ir : NULL, asmFile != "" ? (ostream*)&mips : &cout);
+        ir.close();
+        mips.close();
+        if(!succeeded)
+        {
+            if(irFile != "")
+            {
+                remove(irFile.c_str());
+            }
+            if(asmFile != "")
+            {
+                remove(asmFile.c_str());
+            }
+        }
+        return succeeded;
+    }
+
+    // write to memory first, so that nothing is written if there's an error
+    ostringstream ir, mips;
+    if(!compile(&source, irFile != "" ? &ir : NULL, &mips))
+    {
+        return false;
+    }
+    if(irFile != "")
+    {
+        ofstream file(irFile);
+        file << ir.str();
+    }
+    if(asmFile != "")
+    {
+        ofstream file(asmFile);
+        file << mips.str();
+    }
+    else
+    {
+        cout << mips.str();
+    }
+    return true;
+}
+
+BatchCompiler::BatchCompiler(int workerNum, string outputDir, bool emitIR, bool streaming, bool dumpCFG, bool optimize)
+{
+    this->streaming = streaming;
+    this->dumpCFG = dumpCFG;
+    this->optimize = optimize;
+    this->workerNum = workerNum > 0 ? workerNum : 1;
+    this->outputDir = outputDir;
+    this->emitIR = emitIR;
+    this->totalSeconds = 0;
+}
+
+void BatchCompiler::addSource(string sourceFile)
+{
+    sourceFiles.push_back(sourceFile);
+}
+
+/*
+ * Add all the sources listed in a manifest file, one path per line.
+ * Empty lines and lines starting with '#' are ignored.
+ */
+bool BatchCompiler::addManifest(string manifestFile)
+{
+    ifstream manifest(manifestFile);
+    if(!manifest.is_open())
+    {
+        return false;
+    }
+    string line;
+    while(getline(manifest, line))
+    {
+        if(line != "" && line[0] != '#')
+        {
+            addSource(line);
+        }
+    }
+    return true;
+}
+
+/*
+ * foo/bar.cmm -> outputDir/bar.extension, or foo/bar.extension if no output directory is given.
+ */
+string BatchCompiler::outputFile(string sourceFile, string extension)
+{
+    string stem = sourceFile;
+    size_t slash = stem.find_last_of('/');
+    size_t dot = stem.find_last_of('.');
+    if(dot != string::npos && (slash == string::npos || dot > slash))
+    {
+        stem = stem.substr(0, dot);
+    }
+    if(outputDir != "")
+    {
+        stem = outputDir + "/" + (slash == string::npos ? stem : stem.substr(slash + 1));
+    }
+    return stem + extension;
+}
+
+void BatchCompiler::compileOne(Compiler& compiler, int index)
+{
+    CompileResult& result = results[index];
+    ostringstream diagnostics;
+    compiler.setDiagnostics(&diagnostics);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    result.sourceFile = sourceFiles[index];
+    result.succeeded = compiler.compile(sourceFiles[index],
+                                        outputFile(sourceFiles[index], ".s"),
+                                        emitIR ? outputFile(sourceFiles[index], ".ir") : "");
+    result.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    result.diagnostics = diagnostics.str();
+}
+
+/*
+ * Each worker takes the next file not compiled yet, until all are done.
+ * A worker reuses one compiler for all its files.
+ * A source whose output file is that of an earlier one, as a/x.cmm and b/x.cmm with an output directory,
+ * or a source given twice, fails without being compiled, so no two workers write the same file.
+ */
+void BatchCompiler::run()
+{
+    results.assign(sourceFiles.size(), CompileResult());
+    atomic<int> next(0);
+    int fileNum = sourceFiles.size();
+    vector<bool> collided(fileNum, false);
+    unordered_map<string, int> writers;     // .s file -> source writing it
+    for(int i = 0; i < fileNum; i ++)
+    {
+        string asmFile = outputFile(sourceFiles[i], ".s");
+        unordered_map<string, int>::const_iterator it = writers.find(asmFile);
+        if(it == writers.end())
+        {
+            writers[asmFile] = i;
+            continue;
+        }
+        collided[i] = true;
+        results[i].sourceFile = sourceFiles[i];
+        results[i].succeeded = false;
+        results[i].milliseconds = 0;
+        results[i].diagnostics = sourceFiles[i] + ": output file " + asmFile + " is also written for "
+                                 + sourceFiles[it->second] + "\n";
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for(int i = 0; i < workerNum && i < fileNum; i ++)
+    {
+        workers.push_back(thread([this, &next, &collided, fileNum]()
+        {
+            Compiler compiler(NULL);
+            compiler.setStreaming(streaming);
+            compiler.setDumpCFG(dumpCFG);
+            compiler.setOptimize(optimize);
+            int index;
+            while((index = next ++) < fileNum)
+            {
+                if(!collided[index])
+                {
+                    compileOne(compiler, index);
+                }
+            }
+        }));
+    }
+    for(int i = 0; i < (int)workers.size(); i ++)
+    {
+        workers[i].join();
+    }
+    totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void BatchCompiler::printDiagnostics(ostream& out)
+{
+    for(int i = 0; i < (int)results.size(); i ++)
+    {
+        if(results[i].diagnostics != "")
+        {
+            out << results[i].sourceFile << ":" << endl << results[i].diagnostics;
+        }
+    }
+}
+
+/*
+ * Throughput and per-file latency percentiles (nearest rank).
+ */
+void BatchCompiler::printSummary(ostream& out)
+{
+    int fileNum = results.size();
+    int failedNum = 0;
+    vector<double> latencies;
+    for(int i = 0; i < fileNum; i ++)
+    {
+        failedNum += results[i].succeeded ? 0 : 1;
+        latencies.push_back(results[i].milliseconds);
+    }
+    sort(latencies.begin(), latencies.end());
+    out << fileNum << " files, " << failedNum << " failed, " << workerNum << " workers, "
+        << totalSeconds << " s, " << (totalSeconds > 0 ? fileNum / totalSeconds : 0) << " files/s" << endl;
+    if(fileNum == 0)
+    {
+        return;
+    }
+    const int percents[] = {50, 90, 99, 100};
+    out << "latency (ms):";
+    for(int i = 0; i < 4; i ++)
+    {
+        int rank = (percents[i] * fileNum + 99) / 100;  // ceil(p * n)
+        out << (percents[i] == 100 ? " max " : (" p" + to_string(percents[i]) + " ")) << latencies[max(rank, 1) - 1];
+    }
+    out << endl;
+}
+
+bool BatchCompiler::allSucceeded()
+{
+    for(int i = 0; i < (int)results.size(); i ++)
+    {
+        if(!results[i].succeeded)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef _COMPILER_H
+#define _COMPILER_H
+
+#include "common.h"
+#include "parseCommon.h"
+#include "SemanticAnalyzer.h"
+#include "InterCode.h"
+#include "MIPS.h"
+#include "CFG.h"
+#include <vector>
+
+/*
+ * Runs the whole pipeline on one source file:
+ * parse, semantic analysis, inter code, MIPS32.
+ * A compiler keeps its parse context, semantic analyzer and translaters between files, they are reset before each file,
+ * so compiling many files with the same compiler saves setting them up again,
+ * and the memory taken by one file is reused by the next instead of being allocated again.
+ * Compilers share nothing, each thread should use its own.
+ */
+class Compiler
+{
+private:
+    ostream* diagnostics;   // error messages of the file being compiled
+    ParseContext parseContext;
+    SemanticAnalyzer semanticAnalyzer;
+    InterCodeTranslater interCodeTranslater;
+    MIPS32Translater mips32Translater;
+    bool streaming;
+    bool dumpCFG;
+    bool optimize;
+
+    bool compileStreaming(SourceBuffer* source, ostream* irOutput, ostream* asmOutput);
+    void outputIR(ostream& out);
+public:
+    Compiler(ostream* diagnostics);
+    void setDiagnostics(ostream* diagnostics);
+    /*
+     * In streaming mode, each ExtDef is compiled and written out as soon as it's parsed, then its sub tree is freed,
+     * instead of building the tree of the whole program first.
+     * Output of the ExtDefs before an error has been written by the time the error is found.
+     * Semantic errors in ExtDefs before a lexical or syntax error are reported too.
+     */
+    void setStreaming(bool streaming);
+    /*
+     * Write the inter codes of each function as its control flow graph, block by block with the edges,
+     * instead of one code per line. See CFG::dump().
+     */
+    void setDumpCFG(bool dumpCFG);
+    /*
+     * Optimize the inter codes of each function before they are written out and translated to MIPS32,
+     * see InterCodeTranslater::optimize().
+     */
+    void setOptimize(bool optimize);
+    /*
+     * @param irOutput, asmOutput
+     *  Where to write inter codes and MIPS32 code, NULL to skip.
+     * @return
+     *  false if the source has any error. Nothing is written then, unless streaming.
+     */
+    bool compile(SourceBuffer* source, ostream* irOutput, ostream* asmOutput);
+    /*
+     * @param asmFile
+     *  File to write MIPS32 code, "" for stdout.
+     * @param irFile
+     *  File to write inter codes, "" to skip.
+     * @return
+     *  false if the file can't be read or has any error. No output file is left then.
+     */
+    bool compile(string sourceFile, string asmFile, string irFile);
+};
+
+struct CompileResult
+{
+    string sourceFile;
+    bool succeeded;
+    double milliseconds;
+    string diagnostics;
+};
+
+/*
+ * Compile many files on a fixed number of worker threads.
+ * Every file gets its own .s (and .ir) file, and diagnostics are printed in the order of inputs,
+ * so the result doesn't depend on scheduling.
+ */
+class BatchCompiler
+{
+private:
+    vector<string> sourceFiles;
+    vector<CompileResult> results;
+    int workerNum;
+    string outputDir;   // "" to put outputs next to sources
+    bool emitIR;
+    bool streaming;
+    bool dumpCFG;
+    bool optimize;
+    double totalSeconds;
+
+    string outputFile(string sourceFile, string extension);
+    void compileOne(Compiler& compiler, int index);
+public:
+    BatchCompiler(int workerNum, string outputDir, bool emitIR, bool streaming, bool dumpCFG, bool optimize);
+    void addSource(string sourceFile);
+    bool addManifest(string manifestFile);
+    void run();
+    void printDiagnostics(ostream& out);
+    void printSummary(ostream& out);
+    bool allSucceeded();
+};
+
+#endif
@@ -0,0 +1,396 @@
+#include "ConstantPropagation.h"
+#include <algorithm>
+#include <limits.h>
+
+ConstantPropagation::ConstantPropagation(IRCodes& unit)
+    : unit(unit)
+{
+}
+
+ConstantPropagation::Value ConstantPropagation::meet(Value a, Value b)
+{
+    if(a.level == Value::UNKNOWN)
+    {
+        return b;
+    }
+    if(b.level == Value::UNKNOWN || (a.level == Value::CONSTANT && b.level == Value::CONSTANT && a.constant == b.constant))
+    {
+        return a;
+    }
+    Value varying = { Value::VARYING, 0 };
+    return varying;
+}
+
+bool ConstantPropagation::compare(int x, const string& relop, int y)
+{
+    if(relop == "==") return x == y;
+    if(relop == "!=") return x != y;
+    if(relop == "<") return x < y;
+    if(relop == "<=") return x <= y;
+    if(relop == ">") return x > y;
+    return x >= y;
+}
+
+/*
+ * Variables left in SSA form are params and variables in memory, and temps set more than once are
+ * read before their def, so only constants and temps set once can be known.
+ */
+ConstantPropagation::Value ConstantPropagation::valueOf(Operand operand)
+{
+    Value value = { Value::VARYING, 0 };
+    if(operand.kind() == CONSTANT)
+    {
+        value.level = Value::CONSTANT;
+        value.constant = unit.getConstant(operand);
+    }
+    else if(operand.kind() == TMP)
+    {
+        unordered_map<uint32_t, Value>::const_iterator it = values.find(operand.bits);
+        if(it != values.end())
+        {
+            value = it->second;
+        }
+    }
+    return value;
+}
+
+/*
+ * Value of what the code at index sets, in the executable edges seen so far.
+ */
+ConstantPropagation::Value ConstantPropagation::evaluate(int index)
+{
+    const InterCode_ &code = unit.codes[index];
+    Value value = { Value::VARYING, 0 };
+    switch(code.kind)
+    {
+        case ASSIGN:
+            return valueOf(code.u.assign.right);
+        case ADD:case SUB:case MUL:case DIV:
+        {
+            Value x = valueOf(code.u.binop.op1), y = valueOf(code.u.binop.op2);
+            if(x.level == Value::VARYING || y.level == Value::VARYING)
+            {
+                return value;
+            }
+            if(x.level == Value::UNKNOWN || y.level == Value::UNKNOWN)
+            {
+                value.level = Value::UNKNOWN;
+                return value;
+            }
+            uint32_t a = x.constant, b = y.constant;
+            switch(code.kind)
+            {
+                case ADD: value.constant = (int)(a + b); break;
+                case SUB: value.constant = (int)(a - b); break;
+                case MUL: value.constant = (int)(a * b); break;
+                default:
+                    if(y.constant == 0 || (x.constant == INT_MIN && y.constant == -1))
+                    {
+                        return value;
+                    }
+                    value.constant = x.constant / y.constant;
+                    break;
+            }
+            value.level = Value::CONSTANT;
+            return value;
+        }
+        case PHI:
+        {
+            // only the args of executable edges count
+            value.level = Value::UNKNOWN;
+            int block = codeBlocks[index];
+            const vector<IRPhiArg> &args = code.u.phi.phi->args;
+            for(int i = 0; i < (int)args.size(); i ++)
+            {
+                if(isExecutable(codeBlocks[args[i].pred], block))
+                {
+                    value = meet(value, valueOf(args[i].value));
+                }
+            }
+            return value;
+        }
+        default:
+            // READ, PARAM, calls
+            return value;
+    }
+}
+
+bool ConstantPropagation::isExecutable(int from, int to) const
+{
+    if(to == -1)
+    {
+        // jump to a label not in the unit, see CFG
+        return false;
+    }
+    const vector<int> &preds = executablePreds[to];
+    return find(preds.begin(), preds.end(), from) != preds.end();
+}
+
+void ConstantPropagation::markEdge(int from, int to)
+{
+    if(to != -1 && !isExecutable(from, to))
+    {
+        executablePreds[to].push_back(from);
+        edgeWorklist.push_back(make_pair(from, to));
+    }
+}
+
+/*
+ * Evaluate the code again, lowering the value it sets, and for the last code of a block,
+ * mark the edges control may leave along.
+ */
+void ConstantPropagation::visit(int index)
+{
+    const InterCode_ &code = unit.codes[index];
+    const Operand *def = code.getDef();
+    if(def != NULL)
+    {
+        unordered_map<uint32_t, Value>::iterator it = values.find(def->bits);
+        if(it != values.end())
+        {
+            Value value = meet(it->second, evaluate(index));
+            if(value.level != it->second.level)
+            {
+                it->second = value;
+                const vector<int> &codes = users[def->bits];
+                codeWorklist.insert(codeWorklist.end(), codes.begin(), codes.end());
+            }
+        }
+    }
+
+    int b = codeBlocks[index];
+    const BasicBlock &block = cfg.getBlock(b);
+    if(index != block.end - 1)
+    {
+        return;
+    }
+    if(code.kind == COND_GOTO)
+    {
+        Value x = valueOf(code.u.condGoto->x), y = valueOf(code.u.condGoto->y);
+        int target = cfg.getLabelBlock(code.u.condGoto->label);
+        if(x.level == Value::CONSTANT && y.level == Value::CONSTANT)
+        {
+            markEdge(b, compare(x.constant, code.u.condGoto->relop, y.constant) ? target : b + 1);
+        }
+        else if(x.level == Value::VARYING || y.level == Value::VARYING)
+        {
+            markEdge(b, b + 1);
+            markEdge(b, target);
+        }
+        return;
+    }
+    for(int i = 0; i < (int)block.succs.size(); i ++)
+    {
+        markEdge(b, block.succs[i]);
+    }
+}
+
+/*
+ * Codes of blocks not reached are removed, args of PHIs along edges not executable dropped,
+ * codes with constant values made t := #k, and IF ... GOTO with one executable edge made to take it.
+ * A jump to the block control falls to anyway is dropped, and so are the labels nothing jumps to any more.
+ * A PHI left with one arg is a copy of it, which keeps PHIs out of blocks whose label is dropped.
+ */
+int ConstantPropagation::rewrite()
+{
+    int changed = 0;
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        int next = b + 1;   // block control falls to, past the ones removed
+        while(next < cfg.getExit() && !reachedBlocks[next])
+        {
+            next ++;
+        }
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            InterCode_ &code = unit.codes[i];
+            if(!reachedBlocks[b])
+            {
+                unit.remove(i);
+                changed ++;
+                continue;
+            }
+            if(code.kind == PHI)
+            {
+                vector<IRPhiArg> &args = code.u.phi.phi->args;
+                for(int j = 0; j < (int)args.size(); j ++)
+                {
+                    if(!isExecutable(codeBlocks[args[j].pred], b))
+                    {
+                        args.erase(args.begin() + j --);
+                    }
+                }
+            }
+            const Operand *def = code.getDef();
+            if(def != NULL && (code.kind == ASSIGN || code.kind == PHI || (code.kind >= ADD && code.kind <= DIV)))
+            {
+                Operand result = *def;
+                Value value = valueOf(result);
+                if(value.level == Value::CONSTANT && !(code.kind == ASSIGN && code.u.assign.right.kind() == CONSTANT))
+                {
+                    code = InterCode_(ASSIGN, result, unit.constant(value.constant));
+                    changed ++;
+                }
+                else if(code.kind == PHI && code.u.phi.phi->args.size() == 1)
+                {
+                    code = InterCode_(ASSIGN, result, code.u.phi.phi->args[0].value);
+                }
+            }
+            else if(code.kind == GOTO || code.kind == COND_GOTO)
+            {
+                Operand label = code.kind == GOTO ? code.u.sinop.op : code.u.condGoto->label;
+                int target = cfg.getLabelBlock(label);
+                if(target == -1)
+                {
+                    continue;
+                }
+                if(target == next || (code.kind == COND_GOTO && !isExecutable(b, target)))
+                {
+                    unit.remove(i);
+                    changed ++;
+                }
+                else if(code.kind == COND_GOTO && !isExecutable(b, b + 1))
+                {
+                    code = InterCode_(GOTO, label);
+                    changed ++;
+                }
+            }
+        }
+    }
+
+    unordered_map<int, bool> targets;   // labels still jumped to
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        const InterCode_ &code = unit.codes[i];
+        if(code.kind == GOTO)
+        {
+            targets[code.u.sinop.op.index()] = true;
+        }
+        else if(code.kind == COND_GOTO)
+        {
+            targets[code.u.condGoto->label.index()] = true;
+        }
+    }
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        if(unit.codes[i].kind == LABEL_DEC && targets.count(unit.codes[i].u.sinop.op.index()) == 0)
+        {
+            unit.remove(i);
+            changed ++;
+        }
+    }
+
+    // a block whose jump or whose succ's label is gone runs on to the next one, its edges get the new last code
+    cfg.build(unit);
+    vector<int> lastCodes(unit.codes.size());
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            lastCodes[i] = block.end - 1;
+        }
+    }
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        if(unit.codes[i].kind == PHI)
+        {
+            vector<IRPhiArg> &args = unit.codes[i].u.phi.phi->args;
+            for(int j = 0; j < (int)args.size(); j ++)
+            {
+                args[j].pred = lastCodes[args[j].pred];
+            }
+        }
+    }
+    return changed;
+}
+
+int ConstantPropagation::run()
+{
+    cfg.build(unit);
+    vector<InterCode_> &codes = unit.codes;
+    codeBlocks.assign(codes.size(), -1);
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            codeBlocks[i] = b;
+        }
+    }
+    executablePreds.assign(cfg.getBlockNum(), vector<int>());
+    reachedBlocks.assign(cfg.getBlockNum(), false);
+
+    unordered_map<uint32_t, int> defNums;
+    for(int i = 0; i < (int)codes.size(); i ++)
+    {
+        const Operand *def = codes[i].getDef();
+        if(def != NULL && def->kind() == TMP)
+        {
+            defNums[def->bits] ++;
+        }
+    }
+    Value unknown = { Value::UNKNOWN, 0 };
+    for(unordered_map<uint32_t, int>::const_iterator it = defNums.begin(); it != defNums.end(); it ++)
+    {
+        if(it->second == 1)
+        {
+            values[it->first] = unknown;
+        }
+    }
+    for(int i = 0; i < (int)codes.size(); i ++)
+    {
+        Operand *uses[3];
+        int useNum = codes[i].getUses(uses);
+        for(int j = 0; j < useNum; j ++)
+        {
+            Operand base = uses[j]->kind() == DEREFER ? uses[j]->base() : *uses[j];
+            if(values.count(base.bits))
+            {
+                users[base.bits].push_back(i);
+            }
+        }
+        if(codes[i].kind == PHI)
+        {
+            const vector<IRPhiArg> &args = codes[i].u.phi.phi->args;
+            for(int j = 0; j < (int)args.size(); j ++)
+            {
+                if(values.count(args[j].value.bits))
+                {
+                    users[args[j].value.bits].push_back(i);
+                }
+            }
+        }
+    }
+
+    // the entry is reached from nowhere
+    edgeWorklist.push_back(make_pair(-1, cfg.getEntry()));
+    while(!edgeWorklist.empty() || !codeWorklist.empty())
+    {
+        if(!edgeWorklist.empty())
+        {
+            int to = edgeWorklist.back().second;
+            edgeWorklist.pop_back();
+            const BasicBlock &block = cfg.getBlock(to);
+            // a block reached before only has its PHIs to look at again
+            bool first = !reachedBlocks[to];
+            reachedBlocks[to] = true;
+            for(int i = block.begin; i < block.end; i ++)
+            {
+                if(first || codes[i].kind == PHI)
+                {
+                    visit(i);
+                }
+            }
+            continue;
+        }
+        int index = codeWorklist.back();
+        codeWorklist.pop_back();
+        if(reachedBlocks[codeBlocks[index]])
+        {
+            visit(index);
+        }
+    }
+    return rewrite();
+}
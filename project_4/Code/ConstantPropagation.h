@@ -0,0 +1,57 @@
+#ifndef _CONSTANT_PROPAGATION_H
+#define _CONSTANT_PROPAGATION_H
+
+#include "common.h"
+#include <vector>
+#include <unordered_map>
+#include "InterCode.h"
+#include "CFG.h"
+
+/*
+ * Sparse conditional constant propagation, by Wegman and Zadeck, on the codes of a function in SSA form.
+ * Each temp set once has a value: UNKNOWN while no def of it is seen to run, then a constant, then VARYING.
+ * Values only go down, from the defs to the codes reading them, and only codes of blocks reached by an
+ * executable edge are evaluated. An IF ... GOTO whose operands are constants makes one of its edges executable,
+ * so a branch never taken doesn't spoil the values of the PHIs it leads to.
+ * Then codes whose value is a constant are made t := #k, for CopyPropagation to propagate,
+ * IF ... GOTO with a single executable edge is made GOTO or dropped, and blocks not reached are removed,
+ * along with the jumps to the next block and the labels left that nothing jumps to.
+ * Values are folded as MIPS32 does, wrapping on overflow, and a division by zero is left for the program to do.
+ */
+class ConstantPropagation
+{
+private:
+    struct Value
+    {
+        enum { UNKNOWN, CONSTANT, VARYING } level;
+        int constant;
+    };
+
+    IRCodes &unit;
+    CFG cfg;
+    vector<int> codeBlocks;                 // code -> its block
+    vector<vector<int> > executablePreds;   // block -> preds whose edge to it is executable
+    vector<bool> reachedBlocks;             // blocks whose codes have been visited
+    unordered_map<uint32_t, Value> values;          // temp set once -> its value
+    unordered_map<uint32_t, vector<int> > users;    // temp set once -> codes reading it, PHIs included
+    vector<pair<int, int> > edgeWorklist;
+    vector<int> codeWorklist;
+
+    static Value meet(Value a, Value b);
+    static bool compare(int x, const string& relop, int y);
+    Value valueOf(Operand operand);
+    Value evaluate(int index);
+    bool isExecutable(int from, int to) const;
+    void markEdge(int from, int to);
+    void visit(int index);
+    int rewrite();
+public:
+    ConstantPropagation(IRCodes& unit);
+    /*
+     * @return
+     *  Number of codes folded or removed.
+     */
+    int run();
+};
+
+#endif
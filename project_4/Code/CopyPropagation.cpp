@@ -0,0 +1,191 @@
+#include "CopyPropagation.h"
+
+CopyPropagation::CopyPropagation(IRCodes& unit)
+    : unit(unit)
+{
+}
+
+/*
+ * Temps made by SSAConverter are set once, temps read before any def are set nowhere.
+ */
+bool CopyPropagation::isSSATemp(Operand operand)
+{
+    if(operand.kind() != TMP)
+    {
+        return false;
+    }
+    unordered_map<uint32_t, int>::const_iterator it = defNums.find(operand.bits);
+    return it != defNums.end() && it->second == 1;
+}
+
+/*
+ * End of the chain of copies from operand, operand itself if it's not a copy dropped.
+ */
+Operand CopyPropagation::valueOf(Operand operand)
+{
+    unordered_map<uint32_t, Operand>::const_iterator it;
+    while(operand.kind() == TMP && (it = values.find(operand.bits)) != values.end())
+    {
+        operand = it->second;
+    }
+    return operand;
+}
+
+/*
+ * Whether the code is t := s or t := PHI(s, ..., s, t), for t and s temps set once or s a constant.
+ */
+bool CopyPropagation::findCopy(int index, Operand *value)
+{
+    const InterCode_ &code = unit.codes[index];
+    Operand result, found = NULL_OPERAND;
+    if(code.kind == ASSIGN)
+    {
+        result = code.u.assign.left;
+        found = valueOf(code.u.assign.right);
+    }
+    else if(code.kind == PHI)
+    {
+        result = code.u.phi.result;
+        const vector<IRPhiArg> &args = code.u.phi.phi->args;
+        for(int i = 0; i < (int)args.size(); i ++)
+        {
+            Operand arg = valueOf(args[i].value);
+            if(arg == result)
+            {
+                continue;
+            }
+            if(!found.isNull() && arg != found)
+            {
+                return false;
+            }
+            found = arg;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    if(!isSSATemp(result) || !(found.kind() == CONSTANT || isSSATemp(found)))
+    {
+        return false;
+    }
+    *value = found;
+    return true;
+}
+
+/*
+ * Make use read the value of the temp it reads, if any.
+ * @return
+ *  false if the value is a constant and constantAllowed is false, use is left as it is then.
+ */
+bool CopyPropagation::propagate(Operand *use, bool constantAllowed)
+{
+    Operand base = use->kind() == DEREFER ? use->base() : *use;
+    if(base.kind() != TMP)
+    {
+        return true;
+    }
+    Operand value = valueOf(base);
+    if(value.kind() == CONSTANT && (!constantAllowed || use->kind() == DEREFER))
+    {
+        return false;
+    }
+    *use = use->kind() == DEREFER ? value.dereference() : value;
+    return true;
+}
+
+/*
+ * Find the copies until no more PHIs turn into copies, then rewrite the reads.
+ * A copy some read still needs is put back as t := s, s being the end of its chain.
+ */
+int CopyPropagation::run()
+{
+    vector<InterCode_> &codes = unit.codes;
+    for(int i = 0; i < (int)codes.size(); i ++)
+    {
+        const Operand *def = codes[i].getDef();
+        if(def != NULL && def->kind() == TMP)
+        {
+            defNums[def->bits] ++;
+        }
+    }
+
+    int dropped = 0;
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        for(int i = 0; i < (int)codes.size(); i ++)
+        {
+            Operand value;
+            if(codes[i].kind != NOP && findCopy(i, &value))
+            {
+                Operand result = *codes[i].getDef();
+                values[result.bits] = value;
+                copyCodes[result.bits] = i;
+                unit.remove(i);
+                dropped ++;
+                changed = true;
+            }
+        }
+    }
+
+    for(int i = 0; i < (int)codes.size(); i ++)
+    {
+        InterCode_ &code = codes[i];
+        Operand *uses[3];
+        int useNum = 0;
+        switch(code.kind)
+        {
+            case NOP:
+                continue;
+            case PHI:
+            {
+                vector<IRPhiArg> &args = code.u.phi.phi->args;
+                for(int j = 0; j < (int)args.size(); j ++)
+                {
+                    args[j].value = valueOf(args[j].value);
+                }
+                continue;
+            }
+            case ADD:case SUB:case MUL:case DIV:
+                // the back end folds two constants
+                if(!propagate(&code.u.binop.op1, code.u.binop.op2.kind() != CONSTANT))
+                {
+                    uses[useNum ++] = &code.u.binop.op1;
+                }
+                if(!propagate(&code.u.binop.op2, code.u.binop.op1.kind() != CONSTANT))
+                {
+                    uses[useNum ++] = &code.u.binop.op2;
+                }
+                break;
+            default:
+            {
+                Operand *all[3];
+                int allNum = code.getUses(all);
+                for(int j = 0; j < allNum; j ++)
+                {
+                    if(!propagate(all[j], true))
+                    {
+                        uses[useNum ++] = all[j];
+                    }
+                }
+                break;
+            }
+        }
+        // reads left as they were need their temps back
+        for(int j = 0; j < useNum; j ++)
+        {
+            Operand base = uses[j]->kind() == DEREFER ? uses[j]->base() : *uses[j];
+            unordered_map<uint32_t, int>::iterator it = copyCodes.find(base.bits);
+            if(it != copyCodes.end())
+            {
+                codes[it->second] = InterCode_(ASSIGN, base, valueOf(base));
+                values.erase(base.bits);
+                copyCodes.erase(it);
+                dropped --;
+            }
+        }
+    }
+    return dropped;
+}
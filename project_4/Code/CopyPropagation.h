@@ -0,0 +1,40 @@
+#ifndef _COPY_PROPAGATION_H
+#define _COPY_PROPAGATION_H
+
+#include "common.h"
+#include <vector>
+#include <unordered_map>
+#include "InterCode.h"
+
+/*
+ * Copy propagation on the codes of a function in SSA form, see SSAConverter.
+ * Each read of a variable is translated to a copy t1 := x first, and each literal to t2 := #k.
+ * In SSA form a temp set once by t := s holds s wherever it's read, so reads of t are made reads of s
+ * and the copy is dropped. A PHI whose args are all the same s, or itself around a loop, is a copy of s too.
+ * Only temps and constants are propagated: variables left in SSA form are params and variables in memory,
+ * and the back end keeps params in $a0-$a3, which calls and write() overwrite.
+ * A copy stays if some read can't take s, e.g. *t or a second constant operand of t1 + t2,
+ * as the back end folds those without checking for division by zero.
+ */
+class CopyPropagation
+{
+private:
+    IRCodes &unit;
+    unordered_map<uint32_t, int> defNums;       // temp -> number of codes that set it
+    unordered_map<uint32_t, Operand> values;    // temp -> operand it's a copy of, for the copies dropped
+    unordered_map<uint32_t, int> copyCodes;     // temp -> index of its dropped copy
+
+    bool isSSATemp(Operand operand);
+    Operand valueOf(Operand operand);
+    bool findCopy(int index, Operand *value);
+    bool propagate(Operand *use, bool constantAllowed);
+public:
+    CopyPropagation(IRCodes& unit);
+    /*
+     * @return
+     *  Number of copies dropped.
+     */
+    int run();
+};
+
+#endif
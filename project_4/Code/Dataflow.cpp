@@ -0,0 +1,355 @@
+#include "Dataflow.h"
+#include <deque>
+#include <algorithm>
+
+/**************************** Locations ***************************/
+Locations::Locations()
+{
+    this->variableNum = 0;
+    this->firstTemp = 0;
+    this->tempNum = 0;
+}
+
+void Locations::build(const IRCodes& unit)
+{
+    // index 0 of the table is not a variable
+    variableNum = unit.variables.size() - 1;
+    int minTemp = -1, maxTemp = -1;
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        const Operand *operands[4];
+        int n = unit.codes[i].getUses(operands);
+        const Operand *def = unit.codes[i].getDef();
+        if(def != NULL)
+        {
+            operands[n ++] = def;
+        }
+        for(int j = 0; j < n; j ++)
+        {
+            Operand operand = *operands[j];
+            if(operand.kind() == DEREFER)
+            {
+                operand = operand.base();
+            }
+            if(operand.kind() != TMP)
+            {
+                continue;
+            }
+            if(minTemp == -1 || operand.index() < minTemp)
+            {
+                minTemp = operand.index();
+            }
+            if(operand.index() > maxTemp)
+            {
+                maxTemp = operand.index();
+            }
+        }
+    }
+    firstTemp = minTemp;
+    tempNum = minTemp == -1 ? 0 : maxTemp - minTemp + 1;
+}
+
+int Locations::getIndex(Operand operand) const
+{
+    switch(operand.kind())
+    {
+        case VARIABLE:
+            return operand.index() - 1;
+        case TMP:
+        {
+            int offset = operand.index() - firstTemp;
+            return (offset >= 0 && offset < tempNum) ? variableNum + offset : -1;
+        }
+        case DEREFER:
+            return getIndex(operand.base());
+        default:
+            return -1;
+    }
+}
+
+Operand Locations::getOperand(int index) const
+{
+    if(index < variableNum)
+    {
+        return Operand::make(VARIABLE, index + 1);
+    }
+    return Operand::make(TMP, firstTemp + index - variableNum);
+}
+
+/**************************** BitVectorDataflow ***************************/
+BitVectorDataflow::BitVectorDataflow()
+{
+    this->cfg = NULL;
+    this->forward = true;
+    this->meetIsUnion = true;
+    this->bitNum = 0;
+}
+
+void BitVectorDataflow::init(const CFG& cfg, int bitNum, bool forward, bool meetIsUnion)
+{
+    this->cfg = &cfg;
+    this->bitNum = bitNum;
+    this->forward = forward;
+    this->meetIsUnion = meetIsUnion;
+    int blockNum = cfg.getBlockNum();
+    gen.assign(blockNum, BitSet(bitNum));
+    kill.assign(blockNum, BitSet(bitNum));
+}
+
+/*
+ * Blocks start at the top of the lattice, all bits for intersection, none for union,
+ * but the entry (exit for a backward problem), where nothing is known, starts and stays empty.
+ * Blocks are first visited in reverse postorder (postorder for a backward problem),
+ * so most of them see their preds (succs) before themselves and few are visited twice.
+ */
+void BitVectorDataflow::solve()
+{
+    int blockNum = cfg->getBlockNum();
+    int boundary = forward ? cfg->getEntry() : cfg->getExit();
+    in.assign(blockNum, BitSet(bitNum, !meetIsUnion));
+    out.assign(blockNum, BitSet(bitNum, !meetIsUnion));
+    // "before" and "after" a block, in the direction of the problem
+    vector<BitSet> &before = forward ? in : out;
+    vector<BitSet> &after = forward ? out : in;
+    before[boundary].setAll(false);
+
+    // unreachable blocks after the others
+    vector<int> order = cfg->getPostorder();
+    if(forward)
+    {
+        reverse(order.begin(), order.end());
+    }
+    vector<bool> visited(blockNum, false);
+    for(int i = 0; i < (int)order.size(); i ++)
+    {
+        visited[order[i]] = true;
+    }
+    for(int b = 0; b < blockNum; b ++)
+    {
+        if(!visited[b])
+        {
+            order.push_back(b);
+        }
+    }
+
+    deque<int> worklist(order.begin(), order.end());
+    vector<bool> inWorklist(blockNum, true);
+    while(!worklist.empty())
+    {
+        int block = worklist.front();
+        worklist.pop_front();
+        inWorklist[block] = false;
+        const BasicBlock &basicBlock = cfg->getBlock(block);
+        const vector<int> &sources = forward ? basicBlock.preds : basicBlock.succs;
+        const vector<int> &targets = forward ? basicBlock.succs : basicBlock.preds;
+        if(block != boundary && !sources.empty())
+        {
+            BitSet &meet = before[block];
+            meet = after[sources[0]];
+            for(int i = 1; i < (int)sources.size(); i ++)
+            {
+                if(meetIsUnion)
+                {
+                    meet.unionWith(after[sources[i]]);
+                }
+                else
+                {
+                    meet.intersectWith(after[sources[i]]);
+                }
+            }
+        }
+        if(after[block].transfer(gen[block], before[block], kill[block]))
+        {
+            for(int i = 0; i < (int)targets.size(); i ++)
+            {
+                if(!inWorklist[targets[i]])
+                {
+                    inWorklist[targets[i]] = true;
+                    worklist.push_back(targets[i]);
+                }
+            }
+        }
+    }
+}
+
+/**************************** Liveness ***************************/
+/*
+ * gen: variables read in the block before it sets them, kill: variables it sets.
+ */
+void Liveness::analyse(const CFG& cfg)
+{
+    const IRCodes &unit = cfg.getUnit();
+    locations.build(unit);
+    init(cfg, locations.size(), false, true);
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        for(int i = block.end - 1; i >= block.begin; i --)
+        {
+            const InterCode_ &code = unit.codes[i];
+            const Operand *def = code.getDef();
+            if(def != NULL)
+            {
+                int index = locations.getIndex(*def);
+                kill[b].set(index);
+                gen[b].reset(index);
+            }
+            const Operand *uses[3];
+            int useNum = code.getUses(uses);
+            for(int j = 0; j < useNum; j ++)
+            {
+                int index = locations.getIndex(*uses[j]);
+                if(index != -1)
+                {
+                    gen[b].set(index);
+                }
+            }
+        }
+    }
+    solve();
+}
+
+/**************************** ReachingDefinitions ***************************/
+/*
+ * gen: the last code in the block that sets each variable, kill: all the codes that set what the block sets.
+ */
+void ReachingDefinitions::analyse(const CFG& cfg)
+{
+    const IRCodes &unit = cfg.getUnit();
+    locations.build(unit);
+    defCodes.clear();
+    vector<int> codeBits(unit.codes.size(), -1);
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        if(unit.codes[i].getDef() != NULL)
+        {
+            codeBits[i] = defCodes.size();
+            defCodes.push_back(i);
+        }
+    }
+    locationDefs.assign(locations.size(), BitSet(defCodes.size()));
+    for(int bit = 0; bit < (int)defCodes.size(); bit ++)
+    {
+        locationDefs[locations.getIndex(*unit.codes[defCodes[bit]].getDef())].set(bit);
+    }
+
+    init(cfg, defCodes.size(), true, true);
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            if(codeBits[i] == -1)
+            {
+                continue;
+            }
+            const BitSet &defs = locationDefs[locations.getIndex(*unit.codes[i].getDef())];
+            gen[b].subtract(defs);
+            gen[b].set(codeBits[i]);
+            kill[b].unionWith(defs);
+        }
+    }
+    solve();
+}
+
+/**************************** AvailableExpressions ***************************/
+/*
+ * Key of the expression of an ADD/SUB/MUL/DIV code, 0 if it reads memory or an address.
+ */
+uint64_t AvailableExpressions::getKey(const InterCode_& code)
+{
+    Operand ops[2] = { code.u.binop.op1, code.u.binop.op2 };
+    for(int i = 0; i < 2; i ++)
+    {
+        OperandKind kind = ops[i].kind();
+        if(kind != VARIABLE && kind != TMP && kind != CONSTANT)
+        {
+            return 0;
+        }
+    }
+    return ((uint64_t)ops[0].bits << 32) | ops[1].bits;
+}
+
+int AvailableExpressions::getExpressionBit(const InterCode_& code) const
+{
+    uint64_t key = getKey(code);
+    if(key == 0)
+    {
+        return -1;
+    }
+    const unordered_map<uint64_t, int> &bits = expressionBits[code.kind - ADD];
+    unordered_map<uint64_t, int>::const_iterator it = bits.find(key);
+    return it == bits.end() ? -1 : it->second;
+}
+
+/*
+ * gen: expressions computed in the block and not killed after, kill: expressions of the variables the block sets.
+ */
+void AvailableExpressions::analyse(const CFG& cfg)
+{
+    const IRCodes &unit = cfg.getUnit();
+    locations.build(unit);
+    expressions.clear();
+    for(int k = 0; k < 4; k ++)
+    {
+        expressionBits[k].clear();
+    }
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        const InterCode_ &code = unit.codes[i];
+        if(code.kind < ADD || code.kind > DIV)
+        {
+            continue;
+        }
+        uint64_t key = getKey(code);
+        if(key != 0 && expressionBits[code.kind - ADD].insert(make_pair(key, (int)expressions.size())).second)
+        {
+            Expression expression;
+            expression.kind = code.kind;
+            expression.op1 = code.u.binop.op1;
+            expression.op2 = code.u.binop.op2;
+            expressions.push_back(expression);
+        }
+    }
+    locationExpressions.assign(locations.size(), BitSet(expressions.size()));
+    for(int bit = 0; bit < (int)expressions.size(); bit ++)
+    {
+        int index1 = locations.getIndex(expressions[bit].op1);
+        int index2 = locations.getIndex(expressions[bit].op2);
+        if(index1 != -1)
+        {
+            locationExpressions[index1].set(bit);
+        }
+        if(index2 != -1)
+        {
+            locationExpressions[index2].set(bit);
+        }
+    }
+
+    init(cfg, expressions.size(), true, false);
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            const InterCode_ &code = unit.codes[i];
+            if(code.kind >= ADD && code.kind <= DIV)
+            {
+                int bit = getExpressionBit(code);
+                if(bit != -1)
+                {
+                    gen[b].set(bit);
+                }
+            }
+            // t := t + 1 computes t + 1, then kills it
+            const Operand *def = code.getDef();
+            if(def != NULL)
+            {
+                const BitSet &killed = locationExpressions[locations.getIndex(*def)];
+                gen[b].subtract(killed);
+                kill[b].unionWith(killed);
+            }
+        }
+    }
+    solve();
+}
@@ -0,0 +1,121 @@
+#ifndef _DATAFLOW_H
+#define _DATAFLOW_H
+
+#include "common.h"
+#include <vector>
+#include <unordered_map>
+#include "InterCode.h"
+#include "CFG.h"
+#include "BitSet.h"
+
+/*
+ * Dense numbers of the variables and temps of a unit, so sets of them can be bit sets.
+ * Variables come first, in the order of the unit's table, then temps in the order of their numbers.
+ * Temps of a function are numbered one after another, so the numbers have few holes.
+ */
+class Locations
+{
+private:
+    int variableNum;
+    int firstTemp, tempNum;     // temps firstTemp .. firstTemp+tempNum-1 are numbered after the variables
+public:
+    Locations();
+    void build(const IRCodes& unit);
+    int size() const { return variableNum + tempNum;}
+    /*
+     * @return
+     *  Number of the VARIABLE or TMP, of x for *x, -1 for other operands.
+     */
+    int getIndex(Operand operand) const;
+    Operand getOperand(int index) const;
+};
+
+/*
+ * Solves a dataflow problem on a CFG, whose facts are bit sets and whose transfer function of a block is
+ *  out = gen | (in & ~kill)
+ * (in and out swap for a backward problem), with union or intersection as the meet of the edges into a block.
+ * Clients fill in gen and kill of each block, then call solve(), which iterates a worklist of blocks
+ * until nothing changes, working on whole words of the sets.
+ */
+class BitVectorDataflow
+{
+protected:
+    const CFG *cfg;
+    bool forward;
+    bool meetIsUnion;   // facts that hold on any path, or on all paths
+    int bitNum;
+    vector<BitSet> gen, kill;
+    vector<BitSet> in, out;     // facts at the start and at the end of each block
+
+    /*
+     * Make gen and kill of each block empty, for bitNum bits.
+     */
+    void init(const CFG& cfg, int bitNum, bool forward, bool meetIsUnion);
+    void solve();
+public:
+    BitVectorDataflow();
+    int getBitNum() const { return bitNum;}
+    const BitSet& getIn(int block) const { return in[block];}
+    const BitSet& getOut(int block) const { return out[block];}
+};
+
+/*
+ * Variables and temps that may be read before they are set again, backward, union.
+ * Bits are numbered by getLocations().
+ */
+class Liveness : public BitVectorDataflow
+{
+private:
+    Locations locations;
+public:
+    void analyse(const CFG& cfg);
+    const Locations& getLocations() const { return locations;}
+};
+
+/*
+ * Codes that set a variable or temp whose value may still be there, forward, union.
+ * Bit i stands for the code getDefCode(i) of the unit.
+ */
+class ReachingDefinitions : public BitVectorDataflow
+{
+private:
+    Locations locations;
+    vector<int> defCodes;       // bit -> index of the code
+    vector<BitSet> locationDefs;    // location -> bits of the codes that set it
+public:
+    void analyse(const CFG& cfg);
+    const Locations& getLocations() const { return locations;}
+    int getDefCode(int bit) const { return defCodes[bit];}
+    const BitSet& getDefsOf(int location) const { return locationDefs[location];}
+};
+
+/*
+ * x op y that has been computed on every path, and none of whose operands has been set since, forward, intersection.
+ * Only expressions of variables, temps and constants are considered, memory isn't tracked.
+ */
+struct Expression
+{
+    InterCodeKind kind;     // ADD, SUB, MUL or DIV
+    Operand op1, op2;
+};
+
+class AvailableExpressions : public BitVectorDataflow
+{
+private:
+    Locations locations;
+    vector<Expression> expressions;     // bit -> expression
+    unordered_map<uint64_t, int> expressionBits[4]; // for each of ADD .. DIV, (op1, op2) -> bit
+    vector<BitSet> locationExpressions; // location -> bits of the expressions that read it
+
+    static uint64_t getKey(const InterCode_& code);
+public:
+    void analyse(const CFG& cfg);
+    const Expression& getExpression(int bit) const { return expressions[bit];}
+    /*
+     * @return
+     *  Bit of the expression computed by an ADD/SUB/MUL/DIV code, -1 if it isn't tracked.
+     */
+    int getExpressionBit(const InterCode_& code) const;
+};
+
+#endif
@@ -1,4 +1,8 @@
 #include "InterCode.h"
+#include "SSA.h"
+#include "ConstantPropagation.h"
+#include "CopyPropagation.h"
+#include <algorithm>
 
 // #define DEBUG
 static void showInfo(Node *node)
@@ -15,39 +19,31 @@ static void showInfo(Node *node)
 #endif
 }
 
-// global variable
-int Operand_::tmp_num = 0, Operand_::label_num = 0;
-
-Operand_::Operand_(OperandKind kind)
+/*
+ * &*t -> t, &x -> ADDRESS of x.
+ * '&' is never applied to an address, nor '*' to a dereference, there's no room for them in 32 bits.
+ */
+Operand Operand::addressOf() const
 {
-    this->kind = kind;
-    if(kind == TMP)
-    {
-        // TMP
-        this->u.tmp_no = ++Operand_::tmp_num;
-    }
-    else
+    if(kind() == DEREFER)
     {
-        // LABEL
-        this->u.label_no = ++Operand_::label_num;
+        return base();
     }
+    Operand op = { bits | (1 << 2) };
+    return op;
 }
 
-Operand_::Operand_(OperandKind kind, int value)
-{
-    this->kind = kind;
-    this->u.int_const = value;
-}
-Operand_::Operand_(OperandKind kind, TableItem* tableItem_p)
-{
-    this->kind = kind;
-    this->u.tableItem_p = tableItem_p;
-}
-
-Operand_::Operand_(OperandKind kind, Operand operand)
+/*
+ * *&t -> t, *t -> DEREFER of t.
+ */
+Operand Operand::dereference() const
 {
-    this->kind = kind;
-    this->u.operand = operand;
+    if(kind() == ADDRESS)
+    {
+        return base();
+    }
+    Operand op = { bits | (2 << 2) };
+    return op;
 }
 
 InterCode_::InterCode_(InterCodeKind kind, Operand op)
@@ -79,6 +75,12 @@ InterCode_::InterCode_(InterCodeKind kind, IRFunction function)
     this->kind = kind;
     this->u.function = function;
 }
+InterCode_::InterCode_(InterCodeKind kind, Operand result, IRPhi phi)
+{
+    this->kind = kind;
+    this->u.phi.result = result;
+    this->u.phi.phi = phi;
+}
 InterCode_::InterCode_(InterCodeKind kind, IRCondGoto condGoto)
 {
     this->kind = kind;
@@ -97,208 +99,313 @@ InterCode_::InterCode_(InterCodeKind kind, Operand result, IRFunction function)
     this->u.assign_call.function = function;
 }
 
-InterCodeTranslater::InterCodeTranslater(SymbolTable* symbolTable)
+Operand* InterCode_::getDef()
 {
-    this->symbolTable = symbolTable;
+    Operand *def;
+    switch(kind)
+    {
+        case ASSIGN:
+            def = &u.assign.left;
+            break;
+        case ADD:case SUB:case MUL:case DIV:
+            def = &u.binop.result;
+            break;
+        case ASSIGN_CALL:
+            def = &u.assign_call.result;
+            break;
+        case READ:case PARAM:
+            def = &u.sinop.op;
+            break;
+        case PHI:
+            def = &u.phi.result;
+            break;
+        default:
+            return NULL;
+    }
+    return (def->kind() == VARIABLE || def->kind() == TMP) ? def : NULL;
 }
 
-InterCodeTranslater::~InterCodeTranslater()
+int InterCode_::getUses(Operand* uses[3])
 {
-
+    int n = 0;
+    switch(kind)
+    {
+        case ASSIGN:
+            if(u.assign.left.kind() == DEREFER)
+            {
+                // *x := y reads x
+                uses[n ++] = &u.assign.left;
+            }
+            uses[n ++] = &u.assign.right;
+            break;
+        case ADD:case SUB:case MUL:case DIV:
+            uses[n ++] = &u.binop.op1;
+            uses[n ++] = &u.binop.op2;
+            break;
+        case RETURN:case WRITE:
+            uses[n ++] = &u.sinop.op;
+            break;
+        case ARG:
+            uses[n ++] = &u.arg.argOp;
+            break;
+        case COND_GOTO:
+            uses[n ++] = &u.condGoto->x;
+            uses[n ++] = &u.condGoto->y;
+            break;
+        default: break;
+    }
+    return n;
 }
 
-void InterCodeTranslater::translate(Node* treeRoot)
+IRCodes::IRCodes()
 {
-    Program(treeRoot);
-    deleteInvalidCodes();
+    // index 0 is never used, so no operand is all zero bits
+    variables.push_back(NULL);
+    constants.push_back(0);
 }
 
-void InterCodeTranslater::output()
+/*
+ * Drop the removed codes, keeping the order of the others. Indexes taken before are no longer valid.
+ */
+void IRCodes::compact()
 {
-    list<InterCode>::iterator it;
-    for(it = interCodeList.begin(); it != interCodeList.end(); it ++)
+    int n = 0;
+    for(int i = 0; i < (int)codes.size(); i ++)
     {
-        cout << toString(*it) << endl;
+        if(codes[i].kind != NOP)
+        {
+            codes[n ++] = codes[i];
+        }
     }
+    codes.erase(codes.begin() + n, codes.end());
 }
 
-void InterCodeTranslater::output(string filename)
+static bool insertionBefore(const pair<int, InterCode_>& a, const pair<int, InterCode_>& b)
 {
-    ofstream file;
-    file.open(filename);
-    if(!file.is_open())
+    return a.first < b.first;
+}
+
+void IRCodes::insert(vector<pair<int, InterCode_> >& insertions)
+{
+    if(insertions.empty())
     {
         return;
     }
-    list<InterCode>::iterator it;
-    for(it = interCodeList.begin(); it != interCodeList.end(); it ++)
+    stable_sort(insertions.begin(), insertions.end(), insertionBefore);
+    vector<InterCode_> merged;
+    merged.reserve(codes.size() + insertions.size());
+    int next = 0;
+    for(int i = 0; i <= (int)codes.size(); i ++)
     {
-        file << toString(*it) << endl;
+        while(next < (int)insertions.size() && insertions[next].first == i)
+        {
+            merged.push_back(insertions[next ++].second);
+        }
+        if(i < (int)codes.size())
+        {
+            merged.push_back(codes[i]);
+        }
     }
-    file.close();
+    codes.swap(merged);
+}
+
+Operand IRCodes::variable(TableItem *tableItem)
+{
+    unordered_map<TableItem*, int>::iterator it = variableIndexes.find(tableItem);
+    if(it != variableIndexes.end())
+    {
+        return Operand::make(VARIABLE, it->second);
+    }
+    variableIndexes.insert(make_pair(tableItem, (int)variables.size()));
+    variables.push_back(tableItem);
+    return Operand::make(VARIABLE, (int)variables.size() - 1);
+}
+
+Operand IRCodes::constant(int value)
+{
+    unordered_map<int, int>::iterator it = constantIndexes.find(value);
+    if(it != constantIndexes.end())
+    {
+        return Operand::make(CONSTANT, it->second);
+    }
+    constantIndexes.insert(make_pair(value, (int)constants.size()));
+    constants.push_back(value);
+    return Operand::make(CONSTANT, (int)constants.size() - 1);
+}
+
+InterCodeTranslater::InterCodeTranslater()
+{
+    this->tmpNum = 0;
+    this->labelNum = 0;
+}
+
+InterCodeTranslater::~InterCodeTranslater()
+{
+
+}
+
+/*
+ * Free all the codes, and number temporaries and labels from 1 again, so the translater can be used for another program.
+ */
+void InterCodeTranslater::reset()
+{
+    program.clear();
+    region.reset();
+    this->tmpNum = 0;
+    this->labelNum = 0;
+}
+
+void InterCodeTranslater::translate(Node* treeRoot)
+{
+    Program(treeRoot);
+}
+
+/*
+ * Translate a single ExtDef, for streaming compilation.
+ * Codes of the previous ExtDef are dropped and freed, the program only holds codes of this one.
+ */
+void InterCodeTranslater::translateExtDef(Node* node)
+{
+    program.clear();
+    region.reset();
+    ExtDef(node);
 }
 
-/**************************** Tool Functions ***************************/
 /*
- * Return byte size of type.
- * int and float take up 4 byte;
+ * Each function is put into SSA form, optimized, and put out of it again.
+ * Constants are found first, their codes made copies of them, so copy propagation puts them where they are read.
+ * The global units have nothing to optimize.
  */
-int InterCodeTranslater::sizeOfType(Type type)
+void InterCodeTranslater::optimize()
 {
-    switch(type->kind)
+    for(int i = 0; i < (int)program.size(); i ++)
     {
-        case BASIC:
-            if(type->u.basic == INT || type->u.basic == FLOAT){
-                return 4;
-            }else{
-                return 0;   // other basic types not supported yet
-            }
-        case ARRAY:
-            // multi dimensions
-            return type->u.array.size * sizeOfType(type->u.array.elem);
-        case STRUCTURE:
+        IRCodes &unit = program[i];
+        if(unit.codes.empty() || unit.codes[0].kind != FUNC_DEF)
         {
-            int totalSize = 0;
-            FieldList field = type->u.structure->structureFieldList;
-            while(field)
-            {
-                totalSize += sizeOfType(field->type);
-                field = field->tail;
-            }
-            return totalSize;
+            continue;
         }
-        case FUNCTION:
-        case ERROR:
-        default: return 0;
+        SSAConverter ssa(*this, unit);
+        ssa.construct();
+        ConstantPropagation(unit).run();
+        CopyPropagation(unit).run();
+        ssa.destruct();
     }
 }
 
-void InterCodeTranslater::deleteInvalidCodes()
+void InterCodeTranslater::output()
+{
+    output(cout);
+}
+
+void InterCodeTranslater::output(string filename)
+{
+    ofstream file;
+    file.open(filename);
+    if(!file.is_open())
+    {
+        return;
+    }
+    output(file);
+    file.close();
+}
+
+void InterCodeTranslater::output(ostream& out)
 {
-    // delete codes with null operands
-    list<InterCode>::iterator it;
-    for(it = interCodeList.begin(); it != interCodeList.end();)
+    for(int i = 0; i < (int)program.size(); i ++)
     {
-        bool invalid = false;
-        switch((*it)->kind)
+        for(int j = 0; j < (int)program[i].codes.size(); j ++)
         {
-            case PARAM:case RETURN:case ARG:case READ:case WRITE:case LABEL_DEC:case GOTO:
-                invalid = ((*it)->u.sinop.op == NULL);
-                break;
-            case ASSIGN:
-                invalid = ((*it)->u.assign.left == NULL || (*it)->u.assign.right == NULL);
-                break;
-            case ADD:case SUB:case MUL:case DIV:
-                invalid = ((*it)->u.binop.result == NULL || (*it)->u.binop.op1 == NULL || (*it)->u.binop.op2 == NULL);
-                break;
-            case DEC:
-                invalid = ((*it)->u.dec.tableItem_p == NULL);
-                break;
-            case ASSIGN_CALL:
-                invalid = ((*it)->u.assign_call.function == NULL || (*it)->u.assign_call.result == NULL);
-                break;
-            case COND_GOTO:
-                invalid = ((*it)->u.condGoto == NULL);
-                break;
-            case FUNC_DEF:
-                invalid = ((*it)->u.function == NULL);
-                break;
-            default: break;
-        }
-        if(invalid){
-            interCodeList.erase(it++);
-        } else {
-            it ++;
+            if(program[i].codes[j].kind != NOP)
+            {
+                out << toString(&program[i].codes[j], program[i]) << endl;
+            }
         }
     }
 }
 
 /************************* End of Tool Functions ***********************/
-string InterCodeTranslater::toString(Operand operand)
+string InterCodeTranslater::toString(Operand operand, const IRCodes& unit)
 {
-    if(operand == NULL)
+    if(operand.isNull())
     {
         return "null operand";
     }
 
-    switch(operand->kind)
+    switch(operand.kind())
     {
         case VARIABLE:
-            return operand->u.tableItem_p->name;
+            return unit.getVariable(operand)->name;
         case CONSTANT:
-            return "#" + to_string(operand->u.int_const);
+            return "#" + to_string(unit.getConstant(operand));
         case TMP:
-            return "t" + to_string(operand->u.tmp_no);
+            return "t" + to_string(operand.index());
         case LABEL:
-            return "label" + to_string(operand->u.label_no);
+            return "label" + to_string(operand.index());
         case ADDRESS:
-        {
-            if(operand->u.operand->kind == DEREFER) {
-                // &*t -> t
-                return toString(operand->u.operand->u.operand);
-            } else {
-                return "&" + toString(operand->u.operand);
-            }
-        }
+            return "&" + toString(operand.base(), unit);
         case DEREFER:
-        {
-            if(operand->u.operand->kind == ADDRESS) {
-                // *&t -> t
-                return toString(operand->u.operand->u.operand);
-            } else {
-                return "*" + toString(operand->u.operand);
-            }
-        }
+            return "*" + toString(operand.base(), unit);
         default:
             return "unrecognized operand";
     }
 }
-string InterCodeTranslater::toString(InterCode interCode)
+string InterCodeTranslater::toString(const InterCode_* interCode, const IRCodes& unit)
 {
 // cout << "code" << interCode->kind << endl;
     switch(interCode->kind)
     {
         case PARAM:
-            return "PARAM " + toString(interCode->u.sinop.op);
+            return "PARAM " + toString(interCode->u.sinop.op, unit);
         case RETURN:
-            return "RETURN " + toString(interCode->u.sinop.op);
+            return "RETURN " + toString(interCode->u.sinop.op, unit);
         case ARG:
-            return "ARG " + toString(interCode->u.arg.argOp);
+            return "ARG " + toString(interCode->u.arg.argOp, unit);
         case READ:
-            return "READ " + toString(interCode->u.sinop.op);
+            return "READ " + toString(interCode->u.sinop.op, unit);
         case WRITE:
-            return "WRITE " + toString(interCode->u.sinop.op);
+            return "WRITE " + toString(interCode->u.sinop.op, unit);
         case LABEL_DEC:
-            return "LABEL " + toString(interCode->u.sinop.op) + " : ";
+            return "LABEL " + toString(interCode->u.sinop.op, unit) + " : ";
         case GOTO:
-            return "GOTO " + toString(interCode->u.sinop.op);
+            return "GOTO " + toString(interCode->u.sinop.op, unit);
         case ASSIGN:
-            return toString(interCode->u.assign.left) + " := " + toString(interCode->u.assign.right);
+            return toString(interCode->u.assign.left, unit) + " := " + toString(interCode->u.assign.right, unit);
         case ADD:
-            return toString(interCode->u.binop.result) + " := " 
-                    + toString(interCode->u.binop.op1) + " + " + toString(interCode->u.binop.op2);
+            return toString(interCode->u.binop.result, unit) + " := " 
+                    + toString(interCode->u.binop.op1, unit) + " + " + toString(interCode->u.binop.op2, unit);
         case SUB:
-            return toString(interCode->u.binop.result) + " := " 
-                    + toString(interCode->u.binop.op1) + " - " + toString(interCode->u.binop.op2);
+            return toString(interCode->u.binop.result, unit) + " := " 
+                    + toString(interCode->u.binop.op1, unit) + " - " + toString(interCode->u.binop.op2, unit);
         case MUL:
-            return toString(interCode->u.binop.result) + " := " 
-                    + toString(interCode->u.binop.op1) + " * " + toString(interCode->u.binop.op2);
+            return toString(interCode->u.binop.result, unit) + " := " 
+                    + toString(interCode->u.binop.op1, unit) + " * " + toString(interCode->u.binop.op2, unit);
         case DIV:
-            return toString(interCode->u.binop.result) + " := " 
-                    + toString(interCode->u.binop.op1) + " / " + toString(interCode->u.binop.op2);
+            return toString(interCode->u.binop.result, unit) + " := " 
+                    + toString(interCode->u.binop.op1, unit) + " / " + toString(interCode->u.binop.op2, unit);
         case DEC:
             return "DEC " + interCode->u.dec.tableItem_p->name + " " + to_string(interCode->u.dec.size);
         case ASSIGN_CALL:
-            return toString(interCode->u.assign_call.result) + " := CALL " + interCode->u.assign_call.function->name; 
+            return toString(interCode->u.assign_call.result, unit) + " := CALL " + interCode->u.assign_call.function->name; 
         case COND_GOTO:
             return "IF " + 
-                toString(interCode->u.condGoto->x) + 
+                toString(interCode->u.condGoto->x, unit) + 
                 " " + interCode->u.condGoto->relop + " " + 
-                toString(interCode->u.condGoto->y) + 
+                toString(interCode->u.condGoto->y, unit) + 
                 " GOTO " + 
-                toString(interCode->u.condGoto->label);
+                toString(interCode->u.condGoto->label, unit);
         case FUNC_DEF:
             return "FUNCTION " + interCode->u.function->name + " :";
+        case PHI:
+        {
+            string code = toString(interCode->u.phi.result, unit) + " := PHI(";
+            const vector<IRPhiArg> &args = interCode->u.phi.phi->args;
+            for(int i = 0; i < (int)args.size(); i ++)
+            {
+                code += (i == 0 ? "" : ", ") + toString(args[i].value, unit);
+            }
+            return code + ")";
+        }
         default: return "unrecognized code";
     }
 }
@@ -321,9 +428,9 @@ void InterCodeTranslater::ExtDefList(Node* node)
         // ExtDefList -> $empty
         return;
     }
-    // ExtDefList -> ExtDef ExtDefList
-    ExtDef(node->getChild(0));
-    ExtDefList(node->getChild(1));
+    // ExtDefList -> ExtDefList ExtDef
+    ExtDefList(node->getChild(0));
+    ExtDef(node->getChild(1));
 
 }
 
@@ -334,6 +441,7 @@ void InterCodeTranslater::ExtDef(Node* node)
     {
         case 0:
             // ExtDef -> Specifier ExtDecList SEMI
+            beginUnit();
             ExtDecList(node->getChild(1));
             return;
         case 1:
@@ -348,18 +456,14 @@ void InterCodeTranslater::ExtDef(Node* node)
         case 3:
         {
             // ExtDef -> Specifier FunDec CompSt
-            Function function = FunDec(node->getChild(1));
-
             // actuall paramNum only needed when called, not defined, simply set it to 0 here
-            InterCode code = new InterCode_(FUNC_DEF, new IRFunction_(function->name, 0));      // code - FUNCTION f :
-            interCodeList.push_back(code);
-            FieldList param = function->params;
-            while(param)
+            InterCode_ code(FUNC_DEF, region.make<IRFunction_>(FunDec(node->getChild(1)), 0));   // code - FUNCTION f :
+            beginUnit();
+            emit(code);
+            if(node->getChild(1)->getProductionNo() == 0)
             {
-                Operand op = new Operand_(VARIABLE, symbolTable->getItemByName(param->name));   // code - PARAM v
-                InterCode paramCode = new InterCode_(PARAM, op);
-                interCodeList.push_back(paramCode);
-                param = param->tail;
+                //FunDec -> ID LP VarList RP
+                VarList(node->getChild(1)->getChild(1));        // code - PARAM v, for each param
             }
 
             CompSt(node->getChild(2));
@@ -418,13 +522,12 @@ void InterCodeTranslater::VarDec(Node* node)
         case 0:
         {
             //VarDec -> ID
-            string name = node->getChild(0)->getText();
-            TableItem *varItem = symbolTable->getItemByName(name);
+            TableItem *varItem = node->getChild(0)->getItem();
             if(varItem != NULL && (varItem->type->kind == ARRAY || varItem->type->kind == STRUCTURE))
             {
-                InterCode code = new InterCode_(DEC, 
-                                        varItem, sizeOfType(varItem->type)); // code - DEC x [size]
-                interCodeList.push_back(code);
+                InterCode_ code(DEC, 
+                                        varItem, varItem->type->size); // code - DEC x [size]
+                emit(code);
             }
             return;
         }
@@ -435,19 +538,16 @@ void InterCodeTranslater::VarDec(Node* node)
     }
 }
 
-Function InterCodeTranslater::FunDec(Node* node)
+/*
+ * Return name of the function.
+ * Params are translated by the caller, only for a definition.
+ */
+string InterCodeTranslater::FunDec(Node* node)
 {
 	showInfo(node);
-    if(node->getProductionNo() == 0)
-    {
-        //FunDec -> ID LP VarList RP
-    }
-    else 
-    {
-        //FunDec -> ID LP RP
-    }
-    string functionName = node->getChild(0)->getText();
-    return symbolTable->getItemByName(functionName)->type->u.function;
+    //FunDec -> ID LP VarList RP
+    //FunDec -> ID LP RP
+    return node->getChild(0)->getText();
 }
 
 void InterCodeTranslater::VarList(Node* node)
@@ -458,7 +558,7 @@ void InterCodeTranslater::VarList(Node* node)
     if(node->getProductionNo() == 0)
     {
         //VarList -> ParamDec COMMA VarList
-        VarList(node->getChild(2));
+        VarList(node->getChild(1));
     }
 }
 
@@ -466,8 +566,15 @@ void InterCodeTranslater::ParamDec(Node* node)
 {
 	showInfo(node);
     //ParamDec -> Specifier VarDec
-    Specifier(node->getChild(0));
-    VarDec(node->getChild(1));
+    Node *varDec = node->getChild(1);
+    while(varDec->getProductionNo() == 1)
+    {
+        //VarDec -> VarDec LB INT RB
+        varDec = varDec->getChild(0);
+    }
+    //VarDec -> ID
+    Operand op = newVariable(varDec->getChild(0)->getItem());
+    emit(InterCode_(PARAM, op));     // code - PARAM v
 }
 
 /* Statements */
@@ -475,8 +582,8 @@ void InterCodeTranslater::CompSt(Node* node)
 {
 	showInfo(node);
     //CompSt -> LC DefList StmtList RC
-    DefList(node->getChild(1));
-    StmtList(node->getChild(2));
+    DefList(node->getChild(0));
+    StmtList(node->getChild(1));
 }
 
 void InterCodeTranslater::StmtList(Node* node)
@@ -499,7 +606,7 @@ void InterCodeTranslater::Stmt(Node* node)
     {
         case 0:
             //Stmt -> Exp SEMI
-            Exp(node->getChild(0), NULL);
+            Exp(node->getChild(0), NULL_OPERAND);
             return;
         case 1:
             //Stmt -> CompSt
@@ -508,60 +615,60 @@ void InterCodeTranslater::Stmt(Node* node)
         case 2:
         {
             //Stmt -> RETURN Exp SEMI
-            Operand t1 = new Operand_(TMP);
-            Exp(node->getChild(1), t1);                     // code 1
-            InterCode code2 = new InterCode_(RETURN, t1);   // code 2
-            interCodeList.push_back(code2);
+            Operand t1 = newTemp();
+            Exp(node->getChild(0), t1);                     // code 1
+            InterCode_ code2(RETURN, t1);   // code 2
+            emit(code2);
             return;
         }
         case 3:
         {
             //Stmt -> IF LP Exp RP Stmt
-            Operand label1 = new Operand_(LABEL);
-            Operand label2 = new Operand_(LABEL);
-            translateCond(node->getChild(2), label1, label2);       // code 1
-            InterCode code1_1 = new InterCode_(LABEL_DEC, label1);  // code 1.1 - [LABEL label1]
-            interCodeList.push_back(code1_1);
-            Stmt(node->getChild(4));                                // code 2
-            InterCode code2_1 = new InterCode_(LABEL_DEC, label2);  // code 2.1 - [LABEL label2]
-            interCodeList.push_back(code2_1);
+            Operand label1 = newLabel();
+            Operand label2 = newLabel();
+            translateCond(node->getChild(0), label1, label2);       // code 1
+            InterCode_ code1_1(LABEL_DEC, label1);  // code 1.1 - [LABEL label1]
+            emit(code1_1);
+            Stmt(node->getChild(1));                                // code 2
+            InterCode_ code2_1(LABEL_DEC, label2);  // code 2.1 - [LABEL label2]
+            emit(code2_1);
             return;
         }
         case 4:
         {
             //Stmt -> IF LP Exp RP Stmt ELSE Stmt
-            Operand label1 = new Operand_(LABEL);
-            Operand label2 = new Operand_(LABEL);
-            Operand label3 = new Operand_(LABEL);
-            translateCond(node->getChild(2), label1, label2);       // code 1
-            InterCode code1_1 = new InterCode_(LABEL_DEC, label1);  // code 1.1 - [LABEL label1]
-            interCodeList.push_back(code1_1);
-            Stmt(node->getChild(4));                                // code 2
-            InterCode code2_1 = new InterCode_(GOTO, label3);       // code 2.1 - [GOTO label3]
-            interCodeList.push_back(code2_1);
-            InterCode code2_2 = new InterCode_(LABEL_DEC, label2);  // code 2.2 - [LABEL label2]
-            interCodeList.push_back(code2_2);
-            Stmt(node->getChild(6));                                // code 3
-            InterCode code3_1 = new InterCode_(LABEL_DEC, label3);  // code 3.1
-            interCodeList.push_back(code3_1);
+            Operand label1 = newLabel();
+            Operand label2 = newLabel();
+            Operand label3 = newLabel();
+            translateCond(node->getChild(0), label1, label2);       // code 1
+            InterCode_ code1_1(LABEL_DEC, label1);  // code 1.1 - [LABEL label1]
+            emit(code1_1);
+            Stmt(node->getChild(1));                                // code 2
+            InterCode_ code2_1(GOTO, label3);       // code 2.1 - [GOTO label3]
+            emit(code2_1);
+            InterCode_ code2_2(LABEL_DEC, label2);  // code 2.2 - [LABEL label2]
+            emit(code2_2);
+            Stmt(node->getChild(2));                                // code 3
+            InterCode_ code3_1(LABEL_DEC, label3);  // code 3.1
+            emit(code3_1);
             return;
         }
         case 5:
         {
             //Stmt -> WHILE LP Exp RP Stmt
-            Operand label1 = new Operand_(LABEL);
-            Operand label2 = new Operand_(LABEL);
-            Operand label3 = new Operand_(LABEL);
-            InterCode code0_1 = new InterCode_(LABEL_DEC, label1);  // code 0.1 - [LABEL label1]
-            interCodeList.push_back(code0_1);
-            translateCond(node->getChild(2), label2, label3);       // code 1
-            InterCode code1_1 = new InterCode_(LABEL_DEC, label2);  // code 1.1 - [LABEL label2]
-            interCodeList.push_back(code1_1);
-            Stmt(node->getChild(4));                                // code 2
-            InterCode code2_1 = new InterCode_(GOTO, label1);       // code 2.1 - [GOTO labe1]
-            interCodeList.push_back(code2_1);
-            InterCode code2_2 = new InterCode_(LABEL_DEC, label3);  // code 2.2 - [LABEL label3]
-            interCodeList.push_back(code2_2);
+            Operand label1 = newLabel();
+            Operand label2 = newLabel();
+            Operand label3 = newLabel();
+            InterCode_ code0_1(LABEL_DEC, label1);  // code 0.1 - [LABEL label1]
+            emit(code0_1);
+            translateCond(node->getChild(0), label2, label3);       // code 1
+            InterCode_ code1_1(LABEL_DEC, label2);  // code 1.1 - [LABEL label2]
+            emit(code1_1);
+            Stmt(node->getChild(1));                                // code 2
+            InterCode_ code2_1(GOTO, label1);       // code 2.1 - [GOTO labe1]
+            emit(code2_1);
+            InterCode_ code2_2(LABEL_DEC, label3);  // code 2.2 - [LABEL label3]
+            emit(code2_2);
             return;
         }
         default: return;
@@ -601,7 +708,7 @@ void InterCodeTranslater::DecList(Node* node)
     }
 
     //DecList -> Dec COMMA DecList
-    DecList(node->getChild(2));
+    DecList(node->getChild(1));
 }
 
 void InterCodeTranslater::Dec(Node* node)
@@ -617,9 +724,9 @@ void InterCodeTranslater::Dec(Node* node)
     if(node->getChild(0)->getProductionNo() == 0)
     {
         // VarDec -> ID
-        TableItem *IDItem = symbolTable->getItemByName(node->getChild(0)->getChild(0)->getText());
-        Operand var = new Operand_(VARIABLE, IDItem);
-        Exp(node->getChild(2), var);     // code - var := e
+        TableItem *IDItem = node->getChild(0)->getChild(0)->getItem();
+        Operand var = newVariable(IDItem);
+        Exp(node->getChild(1), var);     // code - var := e
     }
     // Dec -> arrayElem ASSIGNOP Exp
     // got no idea how this shit could be translated
@@ -633,53 +740,53 @@ ExpResult InterCodeTranslater::translateCond(Node* node, Operand label_true, Ope
         case 3:
         {
             //Exp -> Exp RELOP Exp
-            Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
+            Operand t1 = newTemp();
+            Operand t2 = newTemp();
             ExpResult expResult = Exp(node->getChild(0), t1);                                       // code 1
-            Exp(node->getChild(2), t2);                                                             // code 2
-            string op = node->getChild(1)->getText();
-            InterCode code3 = new InterCode_(COND_GOTO, new IRCondGoto_(t1, t2, label_true, op));   // code 3
-            InterCode code4 = new InterCode_(GOTO, label_false);                                    // code 4
-            interCodeList.push_back(code3);
-            interCodeList.push_back(code4);
+            Exp(node->getChild(1), t2);                                                             // code 2
+            string op = node->getChild(2)->getText();
+            InterCode_ code3(COND_GOTO, region.make<IRCondGoto_>(t1, t2, label_true, op));   // code 3
+            InterCode_ code4(GOTO, label_false);                                    // code 4
+            emit(code3);
+            emit(code4);
             return expResult;
         }
         case 10:
         {
             //Exp -> NOT Exp
-            ExpResult expResult = translateCond(node->getChild(1), label_false, label_true);
+            ExpResult expResult = translateCond(node->getChild(0), label_false, label_true);
             return expResult;
         }
         case 1:
         {
             //Exp -> Exp AND Exp
-            Operand label1 = new Operand_(LABEL);
+            Operand label1 = newLabel();
             ExpResult expResult = translateCond(node->getChild(0), label1, label_false);    // code 1
-            InterCode code = new InterCode_(LABEL_DEC, label1);                             // code 1.1 - [LABEL label1]
-            interCodeList.push_back(code); 
-            translateCond(node->getChild(2), label_true, label_false);                      // code 2
+            InterCode_ code(LABEL_DEC, label1);                             // code 1.1 - [LABEL label1]
+            emit(code); 
+            translateCond(node->getChild(1), label_true, label_false);                      // code 2
             return expResult;
         }
         case 2:
         {
             //Exp -> Exp OR Exp
-            Operand label1 = new Operand_(LABEL);
+            Operand label1 = newLabel();
             ExpResult expResult = translateCond(node->getChild(0), label_true, label1); // code 1
-            InterCode code = new InterCode_(LABEL_DEC, label1);                         // code 1.1 - [LABEL label1]
-            interCodeList.push_back(code); 
-            translateCond(node->getChild(2), label_true, label_false);                  // code 2
+            InterCode_ code(LABEL_DEC, label1);                         // code 1.1 - [LABEL label1]
+            emit(code); 
+            translateCond(node->getChild(1), label_true, label_false);                  // code 2
             return expResult;
         }
         default:
         {
             //common Exp as cond exp
-            Operand t1 = new Operand_(TMP);
+            Operand t1 = newTemp();
             ExpResult expResult = Exp(node, t1);                    // code 1
-            IRCondGoto condGoto = new IRCondGoto_(t1, new Operand_(CONSTANT, 0), label_true, "!=");
-            InterCode code2 = new InterCode_(COND_GOTO, condGoto);  // code 2
-            InterCode code3 = new InterCode_(GOTO, label_false);    // code 3
-            interCodeList.push_back(code2);
-            interCodeList.push_back(code3);
+            IRCondGoto condGoto = region.make<IRCondGoto_>(t1, newConstant(0), label_true, "!=");
+            InterCode_ code2(COND_GOTO, condGoto);  // code 2
+            InterCode_ code3(GOTO, label_false);    // code 3
+            emit(code2);
+            emit(code3);
             return expResult;
         }
     }
@@ -693,12 +800,14 @@ ExpResult InterCodeTranslater::Exp(Node* node, Operand place)
         case 0:
         {
             //Exp -> Exp ASSIGNOP Exp
-            Operand t1 = new Operand_(TMP);
-            Exp(node->getChild(2), t1);                                 // code1
-            ExpResult expResult = Exp(node->getChild(0), place);        // code2.2
+            Operand t1 = newTemp();
+            Exp(node->getChild(1), t1);                                 // code1
+            ExpResult expResult = Exp(node->getChild(0), NULL_OPERAND); // code2 - address of the left side, if needed
             Operand leftOperand = expResult.operand;
-            InterCode code = new InterCode_(ASSIGN, leftOperand, t1);   // code2.1
-            interCodeList.insert(--interCodeList.end(), code);          // insert code2.1 before code2.2      
+            InterCode_ code2_1(ASSIGN, leftOperand, t1);                // code2.1 - left := t1
+            emit(code2_1);
+            InterCode_ code2_2(ASSIGN, place, leftOperand);             // code2.2 - [place := left]
+            emitToPlace(place, code2_2);
             return expResult;
         }
         case 1:
@@ -711,88 +820,83 @@ ExpResult InterCodeTranslater::Exp(Node* node, Operand place)
         {
             //Exp -> Exp RELOP Exp
             // case 1,2,3,10 share the same actions
-            Operand label1 = new Operand_(LABEL);
-            Operand label2 = new Operand_(LABEL);
-            InterCode code0 = new InterCode_(ASSIGN, place, new Operand_(CONSTANT, 0));     // code 0
-            interCodeList.push_back(code0);
+            Operand label1 = newLabel();
+            Operand label2 = newLabel();
+            InterCode_ code0(ASSIGN, place, newConstant(0));     // code 0
+            emitToPlace(place, code0);
             ExpResult expResult = translateCond(node, label1, label2);                      // code 1
-            InterCode code2_1 = new InterCode_(LABEL_DEC, label1);                          // code 2.1
-            InterCode code2_2 = new InterCode_(ASSIGN, place, new Operand_(CONSTANT, 1));   // code 2.2
-            InterCode code3 = new InterCode_(LABEL_DEC, label2);                            // code 3
-            interCodeList.push_back(code2_1);
-            interCodeList.push_back(code2_2);
-            interCodeList.push_back(code3);
+            InterCode_ code2_1(LABEL_DEC, label1);                          // code 2.1
+            InterCode_ code2_2(ASSIGN, place, newConstant(1));   // code 2.2
+            InterCode_ code3(LABEL_DEC, label2);                            // code 3
+            emit(code2_1);
+            emitToPlace(place, code2_2);
+            emit(code3);
             return makeExpResult(expResult.type, place, false);
         }
         case 4:
         {
             //Exp -> Exp PLUS Exp
-            Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
+            Operand t1 = newTempFor(place);
+            Operand t2 = newTempFor(place);
             ExpResult expResult = Exp(node->getChild(0), t1);       // code1
-            Exp(node->getChild(2), t2);                             // code2
-            InterCode code = new InterCode_(ADD, place, t1, t2);    // code3
-            interCodeList.push_back(code);
+            Exp(node->getChild(1), t2);                             // code2
+            InterCode_ code(ADD, place, t1, t2);    // code3
+            emitToPlace(place, code);
             return makeExpResult(expResult.type, place, false);
         }
         case 5:
         {
             //Exp -> Exp MINUS Exp
-            Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
+            Operand t1 = newTempFor(place);
+            Operand t2 = newTempFor(place);
             ExpResult expResult = Exp(node->getChild(0), t1);       // code1
-            Exp(node->getChild(2), t2);                             // code2
-            InterCode code = new InterCode_(SUB, place, t1, t2);    // code3
-            interCodeList.push_back(code);
+            Exp(node->getChild(1), t2);                             // code2
+            InterCode_ code(SUB, place, t1, t2);    // code3
+            emitToPlace(place, code);
             return makeExpResult(expResult.type, place, false);
         }
         case 6:
         {
             //Exp -> Exp STAR Exp
-            Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
+            Operand t1 = newTempFor(place);
+            Operand t2 = newTempFor(place);
             ExpResult expResult = Exp(node->getChild(0), t1);       // code1
-            Exp(node->getChild(2), t2);                             // code2
-            InterCode code = new InterCode_(MUL, place, t1, t2);    // code3
-            interCodeList.push_back(code);
+            Exp(node->getChild(1), t2);                             // code2
+            InterCode_ code(MUL, place, t1, t2);    // code3
+            emitToPlace(place, code);
             return makeExpResult(expResult.type, place, false);
         }
         case 7:
         {
             //Exp -> Exp DIV Exp
-            Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
+            Operand t1 = newTempFor(place);
+            Operand t2 = newTempFor(place);
             ExpResult expResult = Exp(node->getChild(0), t1);       // code1
-            Exp(node->getChild(2), t2);                             // code2
-            InterCode code = new InterCode_(DIV, place, t1, t2);    // code3
-            interCodeList.push_back(code);
+            Exp(node->getChild(1), t2);                             // code2
+            InterCode_ code(DIV, place, t1, t2);    // code3
+            emitToPlace(place, code);
             return makeExpResult(expResult.type, place, false);
         }
-        case 8:
-        {
-            //Exp -> LP Exp RP
-            ExpResult expResult = Exp(node->getChild(1), place);
-            return makeExpResult(expResult.type, expResult.operand, false);
-        }
+        //case 8: Exp -> LP Exp RP is replaced by the inner Exp when building the tree
         case 9:
         {
             //Exp -> MINUS Exp
-            Operand t1 = new Operand_(TMP);
-            ExpResult expResult = Exp(node->getChild(1), t1);                           // code 1
-            InterCode code = new InterCode_(SUB, place, new Operand_(CONSTANT, 0), t1); // code 2
-            interCodeList.push_back(code);
+            Operand t1 = newTempFor(place);
+            ExpResult expResult = Exp(node->getChild(0), t1);                           // code 1
+            InterCode_ code(SUB, place, newConstant(0), t1); // code 2
+            emitToPlace(place, code);
             return makeExpResult(expResult.type, place, false);
         }
         case 11:
         {
             //Exp -> ID LP Args RP
-            string functionName = node->getChild(0)->getText();
+            Symbol functionSymbol = node->getChild(0)->getSymbol();
             list<Operand> arg_list;
-            Args(node->getChild(2), arg_list); // code 1
-            if(functionName.compare("write") == 0)
+            Args(node->getChild(1), arg_list); // code 1
+            if(functionSymbol == SYMBOL_WRITE)
             {
-                InterCode code1_1 = new InterCode_(WRITE, *(--arg_list.end()));     // code 1.1 - [WRITE args[0]]
-                interCodeList.push_back(code1_1);
+                InterCode_ code1_1(WRITE, *(--arg_list.end()));     // code 1.1 - [WRITE args[0]]
+                emit(code1_1);
                 return makeExpResult(NULL, place, false);
             }
             else
@@ -801,135 +905,118 @@ ExpResult InterCodeTranslater::Exp(Node* node, Operand place)
                 int argIndex = arg_list.size() - 1;
                 for(it = arg_list.begin(); it != arg_list.end(); ++it)
                 {
-                    InterCode code2 = new InterCode_(ARG, *it, argIndex);           // code 2 - [ARG args[i]]
-                    interCodeList.push_back(code2);
+                    InterCode_ code2(ARG, *it, argIndex);           // code 2 - [ARG args[i]]
+                    emit(code2);
                     argIndex --;
                 }
-                IRFunction function = new IRFunction_(functionName, arg_list.size());
-                InterCode code2_1 = new InterCode_(ASSIGN_CALL, place, function);   // code 2.1 - [place := CALL f]
-                interCodeList.push_back(code2_1);
-                return makeExpResult(symbolTable->getItemByName(functionName)->type, place, false);
+                IRFunction function = region.make<IRFunction_>(node->getChild(0)->getItem()->name, arg_list.size());
+                // the call is made for its side effects even if its value isn't needed
+                Operand result = place.isNull() ? newTemp() : place;
+                InterCode_ code2_1(ASSIGN_CALL, result, function);  // code 2.1 - [place := CALL f]
+                emit(code2_1);
+                return makeExpResult(node->getType(), place, false);
             }
         }
         case 12:
         {
             //Exp -> ID LP RP
-            string functionName = node->getChild(0)->getText();
-            if(functionName.compare("read") == 0)
+            Symbol functionSymbol = node->getChild(0)->getSymbol();
+            if(functionSymbol == SYMBOL_READ)
             {
-                InterCode code = new InterCode_(READ, place);                   // code - [READ place]
-                interCodeList.push_back(code);
+                Operand result = place.isNull() ? newTemp() : place;   // the input is read anyway
+                InterCode_ code(READ, result);                  // code - [READ place]
+                emit(code);
                 return makeExpResult(NULL, place, false);
             } 
             else 
             {
-                IRFunction function = new IRFunction_(functionName, 0);
-                InterCode code = new InterCode_(ASSIGN_CALL, place, function);  // code - [place := CALL f]
-                interCodeList.push_back(code);
-                return makeExpResult(symbolTable->getItemByName(functionName)->type, place, false);
+                IRFunction function = region.make<IRFunction_>(node->getChild(0)->getItem()->name, 0);
+                Operand result = place.isNull() ? newTemp() : place;
+                InterCode_ code(ASSIGN_CALL, result, function); // code - [place := CALL f]
+                emit(code);
+                return makeExpResult(node->getType(), place, false);
             }
         }
         case 13:
         {
             //Exp -> Exp LB Exp RB
-            ExpResult expResult = Exp(node->getChild(0), NULL);
+            ExpResult expResult = Exp(node->getChild(0), NULL_OPERAND);
             
             Operand baseAddr;
             if(expResult.isPointer || node->getChild(0)->getProductionNo() == 13){
                 // if exp1 is of case 13, which means it returns a derefer of an address within an array
                 // parse the addr of it and set baseAddr
                 baseAddr = expResult.operand;
-                if(baseAddr->kind == DEREFER) {
-                    baseAddr = baseAddr->u.operand;                                         // t3 := baseAddr
+                if(baseAddr.kind() == DEREFER) {
+                    baseAddr = baseAddr.base();                                             // t3 := baseAddr
                 }
             } else {
-                baseAddr = new Operand_(ADDRESS, expResult.operand);                         // t3 := &baseAddr
+                baseAddr = expResult.operand.addressOf();                         // t3 := &baseAddr
             }                    
-            int size = sizeOfType(expResult.type->u.array.elem);
-            Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
-            Operand t3 = new Operand_(TMP);
-            Exp(node->getChild(2), t1).operand;                                             // code - t1 := e2
-            InterCode code1 = new InterCode_(MUL, t2, t1, new Operand_(CONSTANT, size));    // code - t2 := t1 * e2
-            InterCode code2 = new InterCode_(ASSIGN, t3, baseAddr);                         // code - t3 := &baseAddr
+            int size = expResult.type->u.array.elem->size;
+            Operand t1 = newTemp();
+            Operand t2 = newTemp();
+            Operand t3 = newTemp();
+            Exp(node->getChild(1), t1).operand;                                             // code - t1 := e2
+            InterCode_ code1(MUL, t2, t1, newConstant(size));    // code - t2 := t1 * e2
+            InterCode_ code2(ASSIGN, t3, baseAddr);                         // code - t3 := &baseAddr
                                                                                             // or     t3 := baseAddr
-            InterCode code3 = new InterCode_(ADD, t3, t3, t2);                              // code - t3 := t3 + t2
-            InterCode code4 = new InterCode_(ASSIGN, place, new Operand_(DEREFER, t3));     // code - place := *t3
-            interCodeList.push_back(code1);
-            interCodeList.push_back(code2);
-            interCodeList.push_back(code3);
-            interCodeList.push_back(code4);
+            InterCode_ code3(ADD, t3, t3, t2);                              // code - t3 := t3 + t2
+            InterCode_ code4(ASSIGN, place, t3.dereference());     // code - place := *t3
+            emit(code1);
+            emit(code2);
+            emit(code3);
+            emitToPlace(place, code4);
             Type type = (expResult.type->kind == ARRAY) ? (expResult.type->u.array.elem) : (expResult.type);
-            return makeExpResult(type, new Operand_(DEREFER, t3), false);
+            return makeExpResult(type, t3.dereference(), false);
         }
         case 14:
         {
             //Exp -> Exp DOT ID
-            // Operand t1 = new Operand_(TMP);
-            Operand t2 = new Operand_(TMP);
-            Operand t3 = new Operand_(TMP);
+            // Operand t1 = newTemp();
+            Operand t2 = newTemp();
+            Operand t3 = newTemp();
             // ExpResult expResult = Exp(node->getChild(0), t1);                        
-            ExpResult expResult = Exp(node->getChild(0), NULL);
-            InterCode code1 = expResult.isPointer ? 
-                        new InterCode_(ASSIGN, t2, expResult.operand) :                         // code1 - t2 := e
-                        new InterCode_(ASSIGN, t2, new Operand_(ADDRESS, expResult.operand));   // or    - t2 := &e 
-            interCodeList.push_back(code1);
-
-            // search for ID in this struct
-            string IDName = node->getChild(2)->getText();
-            FieldList itr = expResult.type->u.structure->structureFieldList;
-            int offset = 0;
-            Type elemType = NULL;
-            while(itr)
-            {
-                if(itr->name.compare(IDName) == 0)
-                {
-                    elemType = itr->type;
-                    break;
-                }
-                offset += sizeOfType(itr->type);
-                itr = itr->tail;
-            }
-            InterCode code2 = new InterCode_(ADD, 
-                                t3, t2, new Operand_(CONSTANT, offset));    // code2 - t3 := t2 + offset
-            interCodeList.push_back(code2);
-            InterCode code3 = new InterCode_(ASSIGN, 
-                                place, new Operand_(DEREFER, t3));          // code3 - place := *t3
-            interCodeList.push_back(code3);
-
-            return makeExpResult(elemType, new Operand_(DEREFER, t3), false);
+            ExpResult expResult = Exp(node->getChild(0), NULL_OPERAND);
+            InterCode_ code1 = expResult.isPointer ? 
+                        InterCode_(ASSIGN, t2, expResult.operand) :                         // code1 - t2 := e
+                        InterCode_(ASSIGN, t2, expResult.operand.addressOf());   // or    - t2 := &e 
+            emit(code1);
+
+            // the semantic pass has made sure ID is a field of this struct
+            FieldLayout *field = expResult.type->u.structure->layout->getField(node->getChild(1)->getSymbol());
+            InterCode_ code2(ADD, 
+                                t3, t2, newConstant(field->offset));    // code2 - t3 := t2 + offset
+            emit(code2);
+            InterCode_ code3(ASSIGN, 
+                                place, t3.dereference());          // code3 - [place := *t3]
+            emitToPlace(place, code3);
+
+            return makeExpResult(field->type, t3.dereference(), false);
         }
         case 15:
         {
             //Exp -> ID
-            TableItem *IDItem = symbolTable->getItemByName(node->getChild(0)->getText());
-            Operand right = new Operand_(VARIABLE, IDItem);
-            InterCode code = new InterCode_(ASSIGN, place, right); // code - [place := variable.name]
-            interCodeList.push_back(code);
+            TableItem *IDItem = node->getChild(0)->getItem();
+            Operand right = newVariable(IDItem);
+            InterCode_ code(ASSIGN, place, right); // code - [place := variable.name]
+            emitToPlace(place, code);
             return makeExpResult(IDItem->type, right, IDItem->isPointer);
         }
         case 16:
         {    
             //Exp -> INT
-            Operand right = new Operand_(CONSTANT, node->getChild(0)->getIntValue());
-            InterCode code = new InterCode_(ASSIGN, place, right); // code - [place := #value]
-            interCodeList.push_back(code);
-            Type type = new Type_();
-            type->kind = BASIC;
-            type->u.basic = INT;
-            type->assignType = RIGHT;
-            return makeExpResult(type, right, false);
+            Operand right = newConstant(node->getChild(0)->getIntValue());
+            InterCode_ code(ASSIGN, place, right); // code - [place := #value]
+            emitToPlace(place, code);
+            return makeExpResult(node->getType(), right, false);
         }
         case 17:
         {
             //Exp -> FLOAT
             // MARK: InterCode - place := #value
             // float const intercode not supported yet
-            Type type = new Type_();
-            type->kind = BASIC;
-            type->u.basic = FLOAT;
-            type->assignType = RIGHT;
-            return makeExpResult(type, place, false);
+            return makeExpResult(node->getType(), place, false);
         }
     }
 }
@@ -938,19 +1025,21 @@ void InterCodeTranslater::Args(Node* node, list<Operand>& arg_list)
 {
 	showInfo(node);
 	//Exp
-    Operand t1 = new Operand_(TMP);
-    ExpResult e = Exp(node->getChild(0), t1);                                   // code 1 - t1 := e      
-    InterCode code;
-    if(e.type->kind == ARRAY || e.type->kind == STRUCTURE) {
-        code = new InterCode_(ASSIGN, t1, new Operand_(ADDRESS, e.operand));    // code 1 - t1 := &a
-        interCodeList.pop_back();
-        interCodeList.push_back(code);
+    Operand t1 = newTemp();
+    Node *exp = node->getChild(0);
+    if(exp->getType()->kind == ARRAY || exp->getType()->kind == STRUCTURE) {
+        // arrays and structures are passed by address
+        ExpResult e = Exp(exp, NULL_OPERAND);
+        InterCode_ code(ASSIGN, t1, e.operand.addressOf());                    // code 1 - t1 := &a
+        emit(code);
+    } else {
+        Exp(exp, t1);                                                           // code 1 - t1 := e
     }
     arg_list.push_front(t1);
     if(node->getProductionNo() == 0)
     {
         //Exp COMMA Args
-        Args(node->getChild(2), arg_list);  // code 2
+        Args(node->getChild(1), arg_list);  // code 2
     }
     return;
 }
@@ -3,41 +3,67 @@
 
 #include "common.h"
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <fstream>
+#include <stdint.h>
 #include "SyntaxTree.h"
 #include "SymbolTable.h"
+#include "Region.h"
 
 enum OperandKind    {   VARIABLE, TMP, CONSTANT, ADDRESS, DEREFER, LABEL };
 enum InterCodeKind  {   ASSIGN, DEC, 
                         ADD, SUB, MUL, DIV, 
                         FUNC_DEF, PARAM, RETURN, ARG, READ, WRITE, 
                         ASSIGN_CALL, 
-                        LABEL_DEC, GOTO, COND_GOTO };
+                        LABEL_DEC, GOTO, COND_GOTO, 
+                        PHI,    // only in SSA form, see SSAConverter
+                        NOP };  // NOP - removed code, dropped by IRCodes::compact()
 
-typedef struct Operand_*    Operand;
 typedef struct InterCode_*  InterCode;
 typedef struct IRCondGoto_* IRCondGoto;
 typedef struct IRFunction_* IRFunction;
+typedef struct IRPhi_*      IRPhi;
 
-struct Operand_
+/*
+ * An operand is a 32 bits value, copied around rather than allocated:
+ *  bits 0-1    what it's based on, VARIABLE, TMP, CONSTANT or LABEL
+ *  bits 2-3    0, or ADDRESS/DEREFER applied to the base
+ *  bits 4-31   number of a TMP or LABEL, or index of a VARIABLE/CONSTANT in the tables of its IRCodes
+ * Numbers and indexes start from 1, so 0 is left for NULL_OPERAND.
+ * '&' and '*' cancel out when they are applied, so &*t and *&t are simply t,
+ * and the same operand always has the same bits.
+ */
+struct Operand
 {
-    static int tmp_num, label_num; // defined in InterCode.cpp
-    OperandKind kind;
-    union
+    uint32_t bits;
+
+    OperandKind kind() const
     {
-        TableItem* tableItem_p; // VARIABLE
-        int int_const;          // CONSTANT
-        int tmp_no;             // TMP
-        int label_no;           // LABEL
-        Operand operand;        // ADDRESS, DEREFER
-    } u;
+        static const OperandKind baseKinds[4] = { VARIABLE, TMP, CONSTANT, LABEL };
+        switch((bits >> 2) & 3)
+        {
+            case 1: return ADDRESS;
+            case 2: return DEREFER;
+            default: return baseKinds[bits & 3];
+        }
+    }
+    int index() const { return bits >> 4;}     // number of a TMP or LABEL, see above for the others
+    Operand base() const { Operand b = { bits & ~(uint32_t)0xc }; return b;}   // operand '&'/'*' applies to
+    Operand addressOf() const;
+    Operand dereference() const;
+    bool isNull() const { return bits == 0;}
+    bool operator==(Operand other) const { return bits == other.bits;}
+    bool operator!=(Operand other) const { return bits != other.bits;}
 
-    // Constructors
-    Operand_(OperandKind kind);
-    Operand_(OperandKind kind, int int_const);
-    Operand_(OperandKind kind, TableItem* tableItem_p);
-    Operand_(OperandKind kind, Operand operand);
+    static Operand make(OperandKind kind, int index)
+    {
+        static const uint32_t baseBits[6] = { 0, 1, 2, 0, 0, 3 };  // indexed by OperandKind
+        Operand op = { ((uint32_t)index << 4) | baseBits[kind] };
+        return op;
+    }
 };
+const Operand NULL_OPERAND = { 0 };
 
 struct InterCode_
 {
@@ -52,6 +78,7 @@ struct InterCode_
         struct {Operand argOp; int argIndex;} arg;                  // ARG
         IRCondGoto condGoto;                                        // COND_GOTO
         IRFunction function;                                        // FUNC_DEF
+        struct {Operand result; IRPhi phi;} phi;                    // PHI
     } u;
 
     // Constructors
@@ -63,10 +90,59 @@ struct InterCode_
     InterCode_(InterCodeKind kind, Operand argOp, int argIndex);
     InterCode_(InterCodeKind kind, IRCondGoto condGoto);
     InterCode_(InterCodeKind kind, IRFunction function);
+    InterCode_(InterCodeKind kind, Operand result, IRPhi phi);
+
+    /*
+     * The VARIABLE or TMP whose value the code sets: left of :=, or the operand of READ and PARAM.
+     * NULL if there's none, e.g. *x := y sets memory rather than x.
+     */
+    Operand* getDef();
+    const Operand* getDef() const { return const_cast<InterCode_*>(this)->getDef();}
+    /*
+     * Operands the code reads, at most 3, e.g. *x and y of *x := y.
+     * They may be constants, or &x which doesn't read x.
+     * Args of a PHI aren't listed, each is read at the end of a pred block rather than by the PHI.
+     * @return
+     *  Number of uses put in uses.
+     */
+    int getUses(Operand* uses[3]);
+    int getUses(const Operand* uses[3]) const { return const_cast<InterCode_*>(this)->getUses(const_cast<Operand**>(uses));}
 
     // InterCode pre, next;
 };
 
+/*
+ * Codes of one function definition (FUNCTION f : first) or of one global ExtDef, in order.
+ * Codes are stored by value and addressed by index, an index stays valid until compact().
+ * Removing a code only marks it NOP, so passes can drop codes while walking the array.
+ */
+struct IRCodes
+{
+    vector<InterCode_> codes;
+    /*
+     * Variables and constants used by the codes, each appears once, from index 1.
+     * Temps and labels are numbered across the whole program, they don't need a table.
+     */
+    vector<TableItem*> variables;
+    vector<int> constants;
+    unordered_map<TableItem*, int> variableIndexes;
+    unordered_map<int, int> constantIndexes;
+
+    IRCodes();
+    void remove(int index){ codes[index].kind = NOP;}
+    void compact();
+    /*
+     * Put each code before the code at its index, indexes are the ones before any insertion.
+     * Codes of the same index keep the order they are given in. Indexes taken before are no longer valid.
+     */
+    void insert(vector<pair<int, InterCode_> >& insertions);
+    Operand variable(TableItem *tableItem);
+    Operand constant(int value);
+    TableItem* getVariable(Operand operand) const { return variables[operand.index()];}   // of a VARIABLE, or the base of one
+    int getConstant(Operand operand) const { return constants[operand.index()];}
+};
+typedef vector<IRCodes> IRProgram;     // units in order of the source
+
 struct IRCondGoto_
 {
     // if x [relop] y goto label
@@ -92,6 +168,22 @@ struct IRFunction_
     }
 };
 
+/*
+ * x := PHI(a, b, ...): x gets the arg of the edge control has come along.
+ * An edge is named by the index of the last code of its pred block, which stays the same while codes are
+ * only removed, so passes on SSA form leave compact() to SSAConverter::destruct().
+ * A pass that removes jumps or labels runs blocks together, and gives their edges the new last codes.
+ */
+struct IRPhiArg
+{
+    int pred;
+    Operand value;
+};
+struct IRPhi_
+{
+    vector<IRPhiArg> args;
+};
+
 struct ExpResult
 {
     Type type;
@@ -107,13 +199,35 @@ struct ExpResult
 class InterCodeTranslater
 {
 private:
-    list<InterCode> interCodeList;
-    list<InterCode> emptyIRList; // empty code list
-    SymbolTable* symbolTable;
+    IRProgram program;
+    Region region;  // conditions and functions of the codes, until reset()
+    int tmpNum, labelNum;   // numbers of temporaries and labels created so far
 
     /**************************** Tool Functions ***************************/
-    int sizeOfType(Type type);
-    void deleteInvalidCodes();
+    Operand newVariable(TableItem *tableItem){ return curUnit().variable(tableItem);}
+    Operand newConstant(int value){ return curUnit().constant(value);}
+    void beginUnit(){ program.push_back(IRCodes());}
+    IRCodes& curUnit()
+    {
+        if(program.empty())
+        {
+            beginUnit();
+        }
+        return program.back();
+    }
+    void emit(const InterCode_& code){ curUnit().codes.push_back(code);}
+    /*
+     * place is NULL_OPERAND when the value of an Exp isn't needed, e.g. an Exp statement.
+     * Codes that only move the value to place are then left out, and so are the temps of its sub-Exps.
+     */
+    void emitToPlace(Operand place, const InterCode_& code)
+    {
+        if(!place.isNull())
+        {
+            emit(code);
+        }
+    }
+    Operand newTempFor(Operand place){ return place.isNull() ? NULL_OPERAND : newTemp();}
     ExpResult makeExpResult(const Type type, Operand operand, bool isPointer)
     {
         ExpResult r;
@@ -125,17 +239,27 @@ private:
     /************************* End of Tool Functions ***********************/
 
 public:
-    InterCodeTranslater(SymbolTable* symbolTable);
+    InterCodeTranslater();
     ~InterCodeTranslater();
     
+    void reset();
     void translate(Node* treeRoot);
+    void translateExtDef(Node* node);
     void output();
     void output(string filename);
-    list<InterCode> getInterCodeList() {
-        return this->interCodeList;
+    void output(ostream& out);
+    const IRProgram& getProgram() {
+        return this->program;
     }
-    static string toString(Operand operand);
-    static string toString(InterCode interCode);
+    /*
+     * Temps and labels are numbered across the program, passes on the codes get new ones here too.
+     */
+    Operand newTemp(){ return Operand::make(TMP, ++tmpNum);}
+    Operand newLabel(){ return Operand::make(LABEL, ++labelNum);}
+    IRPhi newPhi(){ return region.make<IRPhi_>();}
+    void optimize();
+    static string toString(Operand operand, const IRCodes& unit);
+    static string toString(const InterCode_* interCode, const IRCodes& unit);
 
     /*************************** Semantic Actions **************************/
 
@@ -153,7 +277,7 @@ public:
 
     /* Declarators */
     void VarDec(Node* node);
-    Function FunDec(Node* node);
+    string FunDec(Node* node);
     void VarList(Node* node);
     void ParamDec(Node* node);
 
@@ -0,0 +1,112 @@
+#include "Interner.h"
+#include <string.h>
+
+#define INITIAL_SLOT_NUM 256
+
+Interner::Interner()
+{
+    clear();
+}
+
+/*
+ * FNV-1a.
+ */
+unsigned int Interner::hash(const char *text, int length)
+{
+    unsigned int val = 2166136261u;
+    for(int i = 0; i < length; i ++)
+    {
+        val = (val ^ (unsigned char)text[i]) * 16777619u;
+    }
+    return val;
+}
+
+/*
+ * Double the table, only the kept hashes are used to place the names again.
+ */
+void Interner::grow()
+{
+    vector<Symbol> newSlots(slots.size() * 2, 0);
+    unsigned int mask = newSlots.size() - 1;
+    for(Symbol symbol = 0; symbol < names.size(); symbol ++)
+    {
+        unsigned int i = hashes[symbol] & mask;
+        while(newSlots[i] != 0)
+        {
+            i = (i + 1) & mask;
+        }
+        newSlots[i] = symbol + 1;
+    }
+    slots.swap(newSlots);
+}
+
+Symbol Interner::add(const char *text, int length, unsigned int hashValue)
+{
+    Symbol symbol = names.size();
+    names.push_back(string(text, length));
+    hashes.push_back(hashValue);
+    if(names.size() * 2 > slots.size())
+    {
+        grow();
+        return symbol;
+    }
+    unsigned int mask = slots.size() - 1;
+    unsigned int i = hashValue & mask;
+    while(slots[i] != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    slots[i] = symbol + 1;
+    return symbol;
+}
+
+/*
+ * Return the Symbol of a name, -1 if it hasn't been seen.
+ */
+int Interner::find(const char *text, int length, unsigned int hashValue)
+{
+    unsigned int mask = slots.size() - 1;
+    for(unsigned int i = hashValue & mask; slots[i] != 0; i = (i + 1) & mask)
+    {
+        Symbol symbol = slots[i] - 1;
+        const string& name = names[symbol];
+        if(hashes[symbol] == hashValue && (int)name.size() == length && memcmp(name.data(), text, length) == 0)
+        {
+            return symbol;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Get the Symbol of a name, a new one is given if it hasn't been seen.
+ * @param text
+ *  Not necessarily NUL terminated, it's copied if new.
+ */
+Symbol Interner::intern(const char *text, int length)
+{
+    unsigned int hashValue = hash(text, length);
+    int symbol = find(text, length, hashValue);
+    return symbol >= 0 ? symbol : add(text, length, hashValue);
+}
+
+/*
+ * Forget all the names but the predefined ones, so the interner can be used for another program.
+ * The table keeps its size.
+ */
+void Interner::clear()
+{
+    names.clear();
+    hashes.clear();
+    if(slots.empty())
+    {
+        slots.resize(INITIAL_SLOT_NUM, 0);
+    }
+    else
+    {
+        slots.assign(slots.size(), 0);
+    }
+    intern("", 0);
+    intern("read", 4);
+    intern("write", 5);
+}
@@ -0,0 +1,50 @@
+#ifndef _INTERNER_H
+#define _INTERNER_H
+
+#include "common.h"
+#include <vector>
+
+/*
+ * Identifiers are interned by the lexer, later passes only carry and compare the Symbol of a name.
+ * A Symbol is an index into the Interner it comes from, so it's only meaningful within one compilation.
+ */
+typedef unsigned int Symbol;
+
+/*
+ * Names every Interner starts with, so that passes can test for them without a lookup.
+ */
+enum PredefinedSymbol : Symbol
+{
+    SYMBOL_EMPTY,   // "", e.g. name of an anonymous struct
+    SYMBOL_READ,    // "read", built-in function
+    SYMBOL_WRITE,   // "write", built-in function
+    PREDEFINED_SYMBOL_NUM
+};
+
+class Interner
+{
+private:
+    vector<string> names;           // indexed by Symbol
+    vector<unsigned int> hashes;    // hash of each name, kept to grow the table without rehashing the text
+    /*
+     * Open addressing with linear probing, each slot holds Symbol + 1, 0 for an empty slot.
+     * Size is always a power of 2, and kept at least twice the number of names.
+     */
+    vector<Symbol> slots;
+
+    static unsigned int hash(const char *text, int length);
+    void grow();
+    int find(const char *text, int length, unsigned int hashValue);
+    Symbol add(const char *text, int length, unsigned int hashValue);
+
+public:
+    Interner();
+    Symbol intern(const char *text, int length);
+    Symbol intern(const string& name){ return intern(name.data(), name.size());}
+    bool contains(const string& name){ return find(name.data(), name.size(), hash(name.data(), name.size())) >= 0;}
+    const string& getName(Symbol symbol){ return this->names[symbol];}
+    int size(){ return this->names.size();}
+    void clear();
+};
+
+#endif
@@ -1,62 +1,56 @@
 #include "MIPS.h"
+#include <stdint.h>
 
-Operand MIPS32Translater::getSimplifiedOperand(Operand operand)
+void MIPS32Translater::translateInterCodes(const IRProgram& program)
 {
-    // simplify duplicated ADDRESS/DEREFER
-    if(operand->kind == ADDRESS && operand->u.operand->kind == DEREFER)
+    for(int i = 0; i < (int)program.size(); i ++)
     {
-        // &*t -> t
-        return operand->u.operand->u.operand;
+        translateInterCodes(program[i]);
     }
-    if(operand->kind == DEREFER && operand->u.operand->kind == ADDRESS)
-    {
-        // &*t -> t
-        return operand->u.operand->u.operand;
-    }
-    return operand;
 }
-void MIPS32Translater::translateInterCodes(list<InterCode> interCodeList)
+void MIPS32Translater::translateInterCodes(const IRCodes& unit)
 {
-    list<InterCode>::iterator it;
-    for(it = interCodeList.begin(); it != interCodeList.end(); it ++)
+    this->unit = &unit;
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
     {
-        switch((*it)->kind)
+        const InterCode_ *it = &unit.codes[i];
+        switch(it->kind)
         {
-            case ASSIGN: translate_assign(*it); break;
-			case DEC: translate_dec(*it); break;
+            case ASSIGN: translate_assign(it); break;
+			case DEC: translate_dec(it); break;
 			case ADD:
 			case SUB:
 			case MUL:
-			case DIV: translate_binop(*it); break;
-			case FUNC_DEF: translate_funcDef(*it); break;
-			case PARAM: translate_param(*it); break;
-			case RETURN: translate_return(*it); break;
-			case ARG: translate_arg(*it); break;
-			case READ: translate_read(*it); break;
-			case WRITE: translate_write(*it); break;
-			case ASSIGN_CALL: translate_assignCall(*it); break;
-			case LABEL_DEC: translate_labelDec(*it); break;
-			case GOTO: translate_goto(*it); break;
-			case COND_GOTO: translate_condGoto(*it); break;
+			case DIV: translate_binop(it); break;
+			case FUNC_DEF: translate_funcDef(it); break;
+			case PARAM: translate_param(it); break;
+			case RETURN: translate_return(it); break;
+			case ARG: translate_arg(it); break;
+			case READ: translate_read(it); break;
+			case WRITE: translate_write(it); break;
+			case ASSIGN_CALL: translate_assignCall(it); break;
+			case LABEL_DEC: translate_labelDec(it); break;
+			case GOTO: translate_goto(it); break;
+			case COND_GOTO: translate_condGoto(it); break;
             default: continue;
         }
     }
 }
-void MIPS32Translater::translate_assign(InterCode interCode)
+void MIPS32Translater::translate_assign(const InterCode_* interCode)
 {
-    Operand left = getSimplifiedOperand(interCode->u.assign.left), 
-            right = getSimplifiedOperand(interCode->u.assign.right);
+    Operand left = interCode->u.assign.left, 
+            right = interCode->u.assign.right;
     int xRegID = -1, yRegID = -1;
-    if(left->kind == VARIABLE || left->kind == TMP)
+    if(left.kind() == VARIABLE || left.kind() == TMP)
     {
-        switch(right->kind)
+        switch(right.kind())
         {
             case CONSTANT:
             {
                 // x := #k
                 xRegID = getRegID(left);
                 // code - li reg(x), k
-                string code = "li " + getRegName(xRegID) + ", " + to_string(right->u.int_const);
+                string code = "li " + getRegName(xRegID) + ", " + to_string(getConstant(right));
                 codeList.push_back(code);
                 break;
             }
@@ -73,9 +67,9 @@ void MIPS32Translater::translate_assign(InterCode interCode)
             case ADDRESS:
             {
                 // x := &y
-                right = right->u.operand;
+                right = right.base();
                 xRegID = getRegID(left);
-                int varIndex = memManager.getVarIndexByName(InterCodeTranslater::toString(right));
+                int varIndex = memManager.getVarIndex(getVarKey(right));
                 int offset = memManager.varList[varIndex].offset;
                 codeList.push_back("addi " + getRegName(xRegID) + ", $fp, " + to_string(offset));
                 break;
@@ -83,7 +77,7 @@ void MIPS32Translater::translate_assign(InterCode interCode)
             case DEREFER:
             {
                 // x := *y
-                right = right->u.operand;
+                right = right.base();
                 xRegID = getRegID(left), yRegID = getRegID(right);
                 // code - lw reg(x), 0(reg(y))
                 string code = "lw " + getRegName(xRegID) + ", 0(" + getRegName(yRegID) + ")";
@@ -93,22 +87,22 @@ void MIPS32Translater::translate_assign(InterCode interCode)
             default:break;
         }
     }
-    else if(left->kind == DEREFER)
+    else if(left.kind() == DEREFER)
     {
-        left = left->u.operand;
-        if(right->kind == CONSTANT)
+        left = left.base();
+        if(right.kind() == CONSTANT)
         {
             // *x := #k
             xRegID = getRegID(left);
             // can't directly sw a value to memory, use $v1 to pass value
             // code - li $v1, k
-            string code1 = "li $v1, " + to_string(right->u.int_const);
+            string code1 = "li $v1, " + to_string(getConstant(right));
             codeList.push_back(code1);
             // code - sw $v1, 0(reg(x))
             string code2 = "sw $v1, 0(" + getRegName(xRegID) + ")";
             codeList.push_back(code2);
         }
-        else if(right->kind == VARIABLE || right->kind == TMP)
+        else if(right.kind() == VARIABLE || right.kind() == TMP)
         {
             // *x := y
             xRegID  = getRegID(left), yRegID = getRegID(right);
@@ -125,22 +119,29 @@ void MIPS32Translater::translate_assign(InterCode interCode)
         moveReg2Stack(xRegID, memManager.regs[xRegID].var->offset);
     }
 }
-void MIPS32Translater::translate_dec(InterCode interCode)
+void MIPS32Translater::translate_dec(const InterCode_* interCode)
 {
     // add to var list, won't load from memory here
-    memManager.allocRegId(interCode->u.dec.tableItem_p->name, interCode->u.dec.size);
+    memManager.allocRegId(MemManager::getVarKey(interCode->u.dec.tableItem_p), interCode->u.dec.size);
     // allocate space on stack
 }
-void MIPS32Translater::translate_binop(InterCode interCode)
+/*
+ * Whether the constant fits in the 16 bits immediate of addi.
+ */
+static bool isImmediate(int value)
+{
+    return value >= -32768 && value <= 32767;
+}
+void MIPS32Translater::translate_binop(const InterCode_* interCode)
 {
-    Operand result = getSimplifiedOperand(interCode->u.binop.result); 
-    Operand op1 = getSimplifiedOperand(interCode->u.binop.op1); 
-    Operand op2 = getSimplifiedOperand(interCode->u.binop.op2); 
+    Operand result = interCode->u.binop.result; 
+    Operand op1 = interCode->u.binop.op1; 
+    Operand op2 = interCode->u.binop.op2; 
     int resultRegID = getRegID(result);
-    bool hasConstant = op1->kind == CONSTANT || op2->kind == CONSTANT;
-    bool bothConstant = op1->kind == CONSTANT && op2->kind == CONSTANT;
-    int op1Value = ((op1->kind == CONSTANT) ? op1->u.int_const : getRegID(op1));
-    int op2Value = ((op2->kind == CONSTANT) ? op2->u.int_const : getRegID(op2));
+    bool hasConstant = op1.kind() == CONSTANT || op2.kind() == CONSTANT;
+    bool bothConstant = op1.kind() == CONSTANT && op2.kind() == CONSTANT;
+    int op1Value = ((op1.kind() == CONSTANT) ? getConstant(op1) : getRegID(op1));
+    int op2Value = ((op2.kind() == CONSTANT) ? getConstant(op2) : getRegID(op2));
     string code;
     switch(interCode->kind)
     {
@@ -150,9 +151,14 @@ void MIPS32Translater::translate_binop(InterCode interCode)
                 code = "li " + getRegName(resultRegID) + ", " + to_string(op1Value + op2Value);
             } else if(hasConstant){
                 // reg first, constant second
-                code = op2->kind == CONSTANT ? 
-                    "addi " + getRegName(resultRegID) + ", " + getRegName(op1Value) + ", " + to_string(op2Value) :
-                    "addi " + getRegName(resultRegID) + ", " + getRegName(op2Value) + ", " + to_string(op1Value);
+                int regID = op2.kind() == CONSTANT ? op1Value : op2Value;
+                int constant = op2.kind() == CONSTANT ? op2Value : op1Value;
+                if(isImmediate(constant)) {
+                    code = "addi " + getRegName(resultRegID) + ", " + getRegName(regID) + ", " + to_string(constant);
+                } else {
+                    codeList.push_back("li $v1, " + to_string(constant));
+                    code = "add " + getRegName(resultRegID) + ", " + getRegName(regID) + ", $v1";
+                }
             } else {
                 code = "add " + getRegName(resultRegID) + ", " + getRegName(op1Value) + ", " + getRegName(op2Value);
             }
@@ -165,8 +171,11 @@ void MIPS32Translater::translate_binop(InterCode interCode)
                 code = "li " + getRegName(resultRegID) + ", " + to_string(op1Value - op2Value);
             } else if(hasConstant){
                 // reg first, constant second
-                if(op2->kind == CONSTANT) {
-                    code = "addi " + getRegName(resultRegID) + ", " + getRegName(op1Value) + ", -" + to_string(op2Value);
+                if(op2.kind() == CONSTANT && op2Value != INT32_MIN && isImmediate(-op2Value)) {
+                    code = "addi " + getRegName(resultRegID) + ", " + getRegName(op1Value) + ", " + to_string(-op2Value);
+                } else if(op2.kind() == CONSTANT) {
+                    codeList.push_back("li $v1, " + to_string(op2Value));
+                    code = "sub " + getRegName(resultRegID) + ", " + getRegName(op1Value) + ", $v1";
                 } else {
                     codeList.push_back("li $v1, " + to_string(op1Value));
                     code = "sub " + getRegName(resultRegID) + ", $v1, " + getRegName(op2Value);
@@ -184,7 +193,7 @@ void MIPS32Translater::translate_binop(InterCode interCode)
                 codeList.push_back(code);
             } else if(hasConstant){
                 string code2;
-                if(op2->kind == CONSTANT){
+                if(op2.kind() == CONSTANT){
                     code = "li $v1, " + to_string(op2Value);
                     code2 = "mul " + getRegName(resultRegID) + ", " + getRegName(op1Value) + ", $v1";
                 } else {
@@ -206,7 +215,7 @@ void MIPS32Translater::translate_binop(InterCode interCode)
                 codeList.push_back(code);
             } else if(hasConstant){
                 string code2, code3;
-                if(op2->kind == CONSTANT){
+                if(op2.kind() == CONSTANT){
                     code = "li $v1, " + to_string(op2Value);
                     code2 = "div " + getRegName(op1Value) + ", $v1";
                 } else {
@@ -232,7 +241,7 @@ void MIPS32Translater::translate_binop(InterCode interCode)
         moveReg2Stack(resultRegID, memManager.regs[resultRegID].var->offset);
     }
 }
-void MIPS32Translater::translate_funcDef(InterCode interCode)
+void MIPS32Translater::translate_funcDef(const InterCode_* interCode)
 {
     list<string> codes = {
         interCode->u.function->name + ":"
@@ -248,33 +257,33 @@ void MIPS32Translater::translate_funcDef(InterCode interCode)
         codeList.push_back("move $fp, $sp");
     }
     curParamIndex = 0; // prepare for param parsing
+    memManager.clearVars();
     memManager.spOffSet = -44;
 }
-void MIPS32Translater::translate_param(InterCode interCode)
+void MIPS32Translater::translate_param(const InterCode_* interCode)
 {
     // param IRs actually tell where to find these variables
-    string varName = InterCodeTranslater::toString(interCode->u.sinop.op);
+    VarKey key = getVarKey(interCode->u.sinop.op);
     if(curParamIndex <= 3)
     {
         // in reg $a0-$a3 (4-7)
-        Var* var = new Var(varName, 0, 4 + curParamIndex);
-        memManager.varList.push_back(*var);
+        Var* var = memManager.region.make<Var>(key, 0, 4 + curParamIndex);
+        memManager.addVar(*var);
         memManager.regs[4 + curParamIndex].var = var;
     } 
     else
     {
         // on stack
-        Var* var = new Var(varName, 4 * (curParamIndex - 3), -1);
-        memManager.varList.push_back((*var));
+        memManager.addVar(Var(key, 4 * (curParamIndex - 3), -1));
     }
     curParamIndex ++;
 }
-void MIPS32Translater::translate_return(InterCode interCode)
+void MIPS32Translater::translate_return(const InterCode_* interCode)
 {
     Operand op = interCode->u.sinop.op;
-    string value = (op->kind == CONSTANT) ? ("$" + op->u.int_const) : getRegName(getRegID(op));
+    // a constant is loaded to $v1 by getRegID()
     list<string> codes = {
-        "move $v0, " + value,
+        "move $v0, " + getRegName(getRegID(op)),
         // "addi $sp, $fp, 4"
         "move $v1, $ra",
         "lw $ra, 0($fp)",
@@ -283,7 +292,7 @@ void MIPS32Translater::translate_return(InterCode interCode)
     };
     codeList.splice(codeList.end(), codes);
 }
-void MIPS32Translater::translate_arg(InterCode interCode)
+void MIPS32Translater::translate_arg(const InterCode_* interCode)
 {
     // save args to regs or stack
     Operand op = interCode->u.sinop.op;
@@ -292,16 +301,16 @@ void MIPS32Translater::translate_arg(InterCode interCode)
     if(curArgIndex <= 3)
     {
         // in reg $a0-$a3 (4-7)
-        code = (op->kind == CONSTANT) ? 
-                "li " + getRegName(4 + curArgIndex) + ", " + to_string(op->u.int_const) :
+        code = (op.kind() == CONSTANT) ? 
+                "li " + getRegName(4 + curArgIndex) + ", " + to_string(getConstant(op)) :
                 "move " + getRegName(4 + curArgIndex) + ", " + getRegName(getRegID(op));
         codeList.push_back(code);
     }
     else
     {
         // on stack
-        code = (op->kind == CONSTANT) ? 
-                "li $v1, " + to_string(op->u.int_const) :
+        code = (op.kind() == CONSTANT) ? 
+                "li $v1, " + to_string(getConstant(op)) :
                 "move $v1, " + getRegName(getRegID(op)); // to make it simple, move to $v1 first
         memManager.spOffSet -= 4;
         list<string> codes = {
@@ -314,7 +323,7 @@ void MIPS32Translater::translate_arg(InterCode interCode)
     // curArgIndex ++;
 }
 
-void MIPS32Translater::translate_read(InterCode interCode)
+void MIPS32Translater::translate_read(const InterCode_* interCode)
 {
     Operand op = interCode->u.sinop.op;
     int regId = getRegID(op);
@@ -327,7 +336,7 @@ void MIPS32Translater::translate_read(InterCode interCode)
         "lw $ra, 0($fp)",
     };
     codeList.splice(codeList.end(), codes);
-    Var var = memManager.varList[memManager.getVarIndexByName(InterCodeTranslater::toString(op))];
+    Var var = memManager.varList[memManager.getVarIndex(getVarKey(op))];
     if(var.regId >= 4 && var.regId <= 7)
     {
         // it's a param
@@ -340,7 +349,7 @@ void MIPS32Translater::translate_read(InterCode interCode)
         codeList.push_back("sw $v0, " + to_string(var.offset) + "($fp)");
     }
 }
-void MIPS32Translater::translate_write(InterCode interCode)
+void MIPS32Translater::translate_write(const InterCode_* interCode)
 {
     Operand op = interCode->u.sinop.op;
     int regId = getRegID(op);
@@ -355,7 +364,7 @@ void MIPS32Translater::translate_write(InterCode interCode)
     };
     codeList.splice(codeList.end(), codes);
 }
-void MIPS32Translater::translate_assignCall(InterCode interCode)
+void MIPS32Translater::translate_assignCall(const InterCode_* interCode)
 {
     Operand op = interCode->u.assign_call.result;
     IRFunction func = interCode->u.assign_call.function;
@@ -391,7 +400,7 @@ void MIPS32Translater::translate_assignCall(InterCode interCode)
     memManager.spOffSet -= 4;
     codeList.splice(codeList.end(), codes);
     int regId = getRegID(op);
-    Var var = memManager.varList[memManager.getVarIndexByName(InterCodeTranslater::toString(op))];
+    Var var = memManager.varList[memManager.getVarIndex(getVarKey(op))];
     if(var.regId >= 4 && var.regId <= 7)
     {
         // it's a param
@@ -405,13 +414,13 @@ void MIPS32Translater::translate_assignCall(InterCode interCode)
     }
     // curArgIndex = 0;
 }
-void MIPS32Translater::translate_labelDec(InterCode interCode)
+void MIPS32Translater::translate_labelDec(const InterCode_* interCode)
 {
-    codeList.push_back("label" + to_string(interCode->u.sinop.op->u.label_no) + ":");
+    codeList.push_back("label" + to_string(interCode->u.sinop.op.index()) + ":");
 }
-void MIPS32Translater::translate_goto(InterCode interCode)
+void MIPS32Translater::translate_goto(const InterCode_* interCode)
 {
-    codeList.push_back("j label" + to_string(interCode->u.sinop.op->u.label_no));
+    codeList.push_back("j label" + to_string(interCode->u.sinop.op.index()));
 }
 
 string relop2mips(string relop)
@@ -430,9 +439,8 @@ string relop2mips(string relop)
         return "ble";
     }
 }
-bool relopConstant(string relop, Operand x, Operand y)
+bool relopConstant(string relop, int xc, int yc)
 {
-    int xc = x->u.int_const, yc = y->u.int_const;
     if(relop.compare("==") == 0){
         return xc == yc;
     } else if(relop.compare("!=")==0){
@@ -447,17 +455,17 @@ bool relopConstant(string relop, Operand x, Operand y)
         return xc <= yc;
     }
 }
-void MIPS32Translater::translate_condGoto(InterCode interCode)
+void MIPS32Translater::translate_condGoto(const InterCode_* interCode)
 {
     Operand x = interCode->u.condGoto->x;
     Operand y = interCode->u.condGoto->y;
     Operand label = interCode->u.condGoto->label;
     string relop = interCode->u.condGoto->relop;
     string code = "";
-    if(x->kind == CONSTANT && y->kind == CONSTANT) {
-        if(relopConstant(relop, x, y))
+    if(x.kind() == CONSTANT && y.kind() == CONSTANT) {
+        if(relopConstant(relop, getConstant(x), getConstant(y)))
         {
-            codeList.push_back("j label" + to_string(label->u.label_no));
+            codeList.push_back("j label" + to_string(label.index()));
         }
     }
     else
@@ -465,11 +473,42 @@ void MIPS32Translater::translate_condGoto(InterCode interCode)
         int xid = getRegID(x), yid = getRegID(y);
         code = relop2mips(relop) + " " + 
                 getRegName(xid) + ", " + getRegName(yid) + 
-                ", label" + to_string(label->u.label_no);
+                ", label" + to_string(label.index());
         codeList.push_back(code);
     }
 }
-void MIPS32Translater::translate(list<InterCode> interCodeList)
+void MIPS32Translater::translate(const IRProgram& program)
+{
+    translateHeadings();
+    // codes
+    translateInterCodes(program);
+}
+
+/*
+ * For streaming compilation, translate the headings first, then each part of the program in order.
+ * Codes are appended to the code list, call clearCodes() after each output().
+ */
+void MIPS32Translater::translatePart(const IRProgram& program)
+{
+    translateInterCodes(program);
+}
+
+void MIPS32Translater::clearCodes()
+{
+    codeList.clear();
+}
+
+/*
+ * Drop the codes and the state of registers and stack, so the translater can be used for another program.
+ */
+void MIPS32Translater::reset()
+{
+    codeList.clear();
+    memManager.reset();
+    curParamIndex = 0;
+}
+
+void MIPS32Translater::translateHeadings()
 {
     this->codeList.clear();
     // headings
@@ -498,17 +537,11 @@ void MIPS32Translater::translate(list<InterCode> interCodeList)
         "jr $ra\n",
     };
     codeList.assign(headings.begin(), headings.end());
-    // codes
-    translateInterCodes(interCodeList);
 }
 
 void MIPS32Translater::output()
 {
-    list<string>::iterator it;
-    for(it = codeList.begin(); it != codeList.end(); it ++)
-    {
-        cout << *it << endl;
-    }
+    output(cout);
 }
 
 void MIPS32Translater::output(string filename)
@@ -519,12 +552,17 @@ void MIPS32Translater::output(string filename)
     {
         return;
     }
+    output(file);
+    file.close();
+}
+
+void MIPS32Translater::output(ostream& out)
+{
     list<string>::iterator it;
     for(it = codeList.begin(); it != codeList.end(); it ++)
     {
-        file << *it << endl;
+        out << *it << endl;
     }
-    file.close();
 }
 string MIPS32Translater::getRegName(int index)
 {
@@ -546,13 +584,13 @@ void MIPS32Translater::moveReg2Stack(int regID, int offset)
 }
 int MIPS32Translater::getRegID(Operand operand)
 {
-    if(operand->kind == CONSTANT)
+    if(operand.kind() == CONSTANT)
     {
         // for MUL/DIV/COND_GOTO, at most one constant, simply load it to v1
-        codeList.push_back("li $v1, " + to_string(operand->u.int_const));
+        codeList.push_back("li $v1, " + to_string(getConstant(operand)));
         return 3;
     }
-    AllocateRegResult ret = memManager.allocRegId(operand);
+    AllocateRegResult ret = memManager.allocRegId(getVarKey(operand), 4);
     if(ret.needLoadingFromMem)
     {
         moveStack2Reg(ret.regID, ret.offset);   // code - lw reg, offset($fp)
@@ -567,9 +605,71 @@ MemManager::MemManager()
         regs[i].var = NULL;
     }
 }
-AllocateRegResult MemManager::allocRegId(string varName, int size)
+
+/*
+ * Forget all the vars and free them, for another program.
+ */
+void MemManager::reset()
+{
+    spOffSet = -4;
+    clearVars();
+    curRegId = 8;
+}
+/*
+ * Forget the vars of the function before and free them, at the start of each function.
+ * Keys of different functions never meet, so memory stays bounded by the largest function,
+ * however many functions a streamed program has.
+ */
+void MemManager::clearVars()
+{
+    varList.clear();
+    varIndexes.clear();
+    for(int i = 0; i < 32; i ++)
+    {
+        regs[i].var = NULL;
+    }
+    region.reset();
+}
+/*
+ * Key of the slot an operand is kept in.
+ * Operands of a function that InterCodeTranslater::toString() prints the same get the same key.
+ * The lowest 2 bits tell what the operand is, the bits above them are the key of a variable's item,
+ * a temp's number, or the key of the operand that '&'/'*' applies to.
+ */
+VarKey MemManager::getVarKey(Operand operand, const IRCodes& unit)
 {
-    int varId = getVarIndexByName(varName);
+    switch(operand.kind())
+    {
+        case VARIABLE:
+            return getVarKey(unit.getVariable(operand));
+        case TMP:
+            return ((VarKey)operand.index() << 2) | 1;
+        case ADDRESS:
+            return (getVarKey(operand.base(), unit) << 2) | 2;
+        case DEREFER:
+            return (getVarKey(operand.base(), unit) << 2) | 3;
+        default:
+            return 0;
+    }
+}
+/*
+ * Variables are told apart by their items rather than their symbols, as one symbol may name many variables in nested scopes.
+ * Items are aligned, so the lowest 2 bits of the address are already 0.
+ */
+VarKey MemManager::getVarKey(TableItem *tableItem)
+{
+    return (VarKey)(uintptr_t)tableItem;
+}
+
+void MemManager::addVar(Var var)
+{
+    varIndexes.insert(make_pair(var.key, (int)varList.size()));
+    varList.push_back(var);
+}
+
+AllocateRegResult MemManager::allocRegId(VarKey key, int size)
+{
+    int varId = getVarIndex(key);
     // assign in sequence among $t0-$t7
     int allocatedID = curRegId;
     bool needLoadingFromMem = true;
@@ -583,8 +683,8 @@ AllocateRegResult MemManager::allocRegId(string varName, int size)
     {
         // allocate space on stack
         spOffSet -= size;
-        Var* var = new Var(varName, spOffSet, allocatedID);
-        varList.push_back(*var);
+        Var* var = region.make<Var>(key, spOffSet, allocatedID);
+        addVar(*var);
         regs[allocatedID].var = var;
         // it's the first time this var has appeared, no need to load from stack
         needLoadingFromMem = false;
@@ -610,21 +710,13 @@ AllocateRegResult MemManager::allocRegId(string varName, int size)
     }
     return AllocateRegResult(allocatedID, needLoadingFromMem, offset);
 }
-AllocateRegResult MemManager::allocRegId(Operand operand)
-{
-    string varName = InterCodeTranslater::toString(operand);
-    return allocRegId(varName, 4);
-}
 
 
-int MemManager::getVarIndexByName(string name)
+/*
+ * Return -1 if there's no such var.
+ */
+int MemManager::getVarIndex(VarKey key)
 {
-    for(int i = 0; i < varList.size(); i ++)
-    {
-        if(varList[i].name.compare(name) == 0)
-        {
-            return i;
-        }
-    }
-    return -1;
+    unordered_map<VarKey, int>::iterator it = varIndexes.find(key);
+    return it == varIndexes.end() ? -1 : it->second;
 }
\ No newline at end of file
@@ -5,25 +5,31 @@
 #include <list>
 #include <stack>
 #include <fstream>
+#include <unordered_map>
 #include "InterCode.h"
+#include "Region.h"
 
+/*
+ * Identifies the stack slot of a variable or temp, see MemManager::getVarKey().
+ */
+typedef unsigned long long VarKey;
 
 struct Var
 {
-    string name;
+    VarKey key;
     int offset; // offset to fp, i.e, ebp/rbp
     int regId;
 
-    Var(string name, int offset, int regId)
+    Var(VarKey key, int offset, int regId)
     {
-        this->name = name;
+        this->key = key;
         this->offset = offset;
         this->regId = regId;
     }
 };
 struct Reg
 {
-    Var* var;
+    Var* var;   // kept in MemManager::region, apart from the copy in varList
 };
 struct AllocateRegResult
 {
@@ -42,6 +48,7 @@ class MemManager
 public:
     int spOffSet = -4; // sp's offset to fp, init in func_def
     vector<Var> varList;
+    unordered_map<VarKey, int> varIndexes;  // index of the first var in varList with the key
     Reg regs[32];
     string regNames[32] = 
     {
@@ -59,11 +66,16 @@ public:
         "$ra"
     };
     int curRegId = 8;
+    Region region;  // vars held by regs
 
     MemManager();
-    AllocateRegResult allocRegId(string varName, int size);
-    AllocateRegResult allocRegId(Operand operand);
-    int getVarIndexByName(string name);
+    void reset();
+    void clearVars();
+    static VarKey getVarKey(Operand operand, const IRCodes& unit);
+    static VarKey getVarKey(TableItem *tableItem);
+    void addVar(Var var);
+    AllocateRegResult allocRegId(VarKey key, int size);
+    int getVarIndex(VarKey key);
     
 };
 
@@ -77,30 +89,39 @@ private:
     int curParamIndex = 0;  // inc in translate_param, zero in func_def
     // int curArgIndex= 0;     // inc in translate_arg, zero in call/assign_call
 
-    Operand getSimplifiedOperand(Operand operand);
-    void translateInterCodes(list<InterCode> interCodeList);
-    void translate_assign(InterCode interCode);
-    void translate_dec(InterCode interCode);
-    void translate_binop(InterCode interCode);
-    void translate_funcDef(InterCode interCode);
-    void translate_param(InterCode interCode);
-    void translate_return(InterCode interCode);
-    void translate_arg(InterCode interCode);
-    void translate_read(InterCode interCode);
-    void translate_write(InterCode interCode);
-    void translate_assignCall(InterCode interCode);
-    void translate_labelDec(InterCode interCode);
-    void translate_goto(InterCode interCode);
-    void translate_condGoto(InterCode interCode);
+    const IRCodes *unit = NULL;    // codes being translated, operands are looked up in its tables
+
+    int getConstant(Operand operand){ return unit->getConstant(operand);}
+    VarKey getVarKey(Operand operand){ return MemManager::getVarKey(operand, *unit);}
+    void translateInterCodes(const IRProgram& program);
+    void translateInterCodes(const IRCodes& unit);
+    void translate_assign(const InterCode_* interCode);
+    void translate_dec(const InterCode_* interCode);
+    void translate_binop(const InterCode_* interCode);
+    void translate_funcDef(const InterCode_* interCode);
+    void translate_param(const InterCode_* interCode);
+    void translate_return(const InterCode_* interCode);
+    void translate_arg(const InterCode_* interCode);
+    void translate_read(const InterCode_* interCode);
+    void translate_write(const InterCode_* interCode);
+    void translate_assignCall(const InterCode_* interCode);
+    void translate_labelDec(const InterCode_* interCode);
+    void translate_goto(const InterCode_* interCode);
+    void translate_condGoto(const InterCode_* interCode);
 
     string getRegName(int index);
     void moveStack2Reg(int regID, int offset);
     void moveReg2Stack(int regID, int offset);
     int getRegID(Operand operand);
 public:
-    void translate(list<InterCode> interCodeList);
+    void translate(const IRProgram& program);
+    void translateHeadings();
+    void translatePart(const IRProgram& program);
+    void clearCodes();
+    void reset();
     void output();
     void output(string filename);
+    void output(ostream& out);
 };
 
 
@@ -0,0 +1,37 @@
+#ifndef _NODEKIND_H
+#define _NODEKIND_H
+
+/*
+ * Kinds of syntax tree nodes: every token declared in syntax.y, then every non-terminal.
+ * The enum and the name table are both generated from this list, keep them in the same order as syntax.y.
+ */
+#define NODE_KIND_LIST(X) \
+    /* tokens */ \
+    X(INT) X(FLOAT) X(ID) X(SEMI) X(COMMA) X(ASSIGNOP) X(RELOP) \
+    X(PLUS) X(MINUS) X(STAR) X(DIV) X(AND) X(OR) X(NOT) X(DOT) X(TYPE) \
+    X(LP) X(RP) X(LB) X(RB) X(LC) X(RC) \
+    X(STRUCT) X(RETURN) X(IF) X(ELSE) X(WHILE) \
+    /* non-terminals */ \
+    X(Program) X(ExtDefList) X(ExtDef) X(ExtDecList) \
+    X(Specifier) X(StructSpecifier) X(OptTag) X(Tag) \
+    X(VarDec) X(FunDec) X(VarList) X(ParamDec) \
+    X(CompSt) X(StmtList) X(Stmt) \
+    X(DefList) X(Def) X(DecList) X(Dec) \
+    X(Exp) X(Args)
+
+enum class NodeKind : unsigned char
+{
+#define NODE_KIND_ENUM(name) name,
+    NODE_KIND_LIST(NODE_KIND_ENUM)
+#undef NODE_KIND_ENUM
+    NODE_KIND_NUM
+};
+
+extern const char* const nodeKindNames[(int)NodeKind::NODE_KIND_NUM];
+
+inline const char* nodeKindName(NodeKind kind)
+{
+    return nodeKindNames[(int)kind];
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "parseCommon.h"
+
+ParseContext::ParseContext()
+{
+    treeRoot = NULL;
+    syntaxErrorFlag = NO_SYNTAX_ERROR;
+    lexErrorFlag = NO_LEX_ERROR;
+    column = 1;
+    scanner = NULL;
+    diagnostics = &cout;
+    extDefHandler = NULL;
+}
+
+ParseContext::~ParseContext()
+{
+    clear();
+}
+
+/*
+ * Scan and parse a whole source file, the tree is left in treeRoot.
+ * The source buffer is scanned in place, no copy is made.
+ */
+void ParseContext::parse(SourceBuffer* source)
+{
+    clear();
+    yylex_init_extra(this, &scanner);
+    YY_BUFFER_STATE buffer = yy_scan_buffer(source->getData(), source->getScanSize(), scanner);
+    yyset_lineno(1, scanner);   // yy_scan_buffer() leaves the line number of a new buffer uninitialized
+    streamMark = nodePool.mark();
+    if(yyparse(scanner, this) != 0)
+    {
+        // the parser gave up, e.g. an error that can't be recovered from before the end of file
+        syntaxErrorFlag = NEAR_END_ERROR;
+    }
+    yy_delete_buffer(buffer, scanner);
+    yylex_destroy(scanner);
+    scanner = NULL;
+}
+
+/*
+ * Destroy the tree and reset all the flags, so that the context can be used for another file.
+ * The node pool keeps its memory for the next tree.
+ */
+void ParseContext::clear()
+{
+    nodePool.reset();
+    interner.clear();
+    treeRoot = NULL;
+    syntaxErrorFlag = NO_SYNTAX_ERROR;
+    lexErrorFlag = NO_LEX_ERROR;
+    column = 1;
+}
+
+/*
+ * Called by the parser in streaming mode, when an ExtDef is reduced.
+ * Hand it over unless there's been an error, then destroy its sub tree.
+ * @param lookahead
+ *  The parser may have read the next token already,
+ *  if it has a node, the node is kept and the pointer updated.
+ */
+void ParseContext::streamExtDef(Node* extDef, Node** lookahead)
+{
+    if(!hasError())
+    {
+        extDefHandler->handleExtDef(extDef);
+    }
+    nodePool.release(streamMark, lookahead);
+}
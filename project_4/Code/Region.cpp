@@ -0,0 +1,52 @@
+#include "Region.h"
+
+Region::Region()
+{
+    chunkIndex = -1;
+    chunkUsed = REGION_CHUNK_SIZE;
+}
+
+Region::~Region()
+{
+    reset();
+    for(int i = 0; i < (int)chunks.size(); i ++)
+    {
+        ::operator delete(chunks[i]);
+    }
+}
+
+/*
+ * Objects are small, one never takes more than a chunk.
+ * The tail of a chunk is simply skipped if it can't hold the object.
+ */
+void* Region::allocate(size_t size, size_t align)
+{
+    size_t offset = (chunkUsed + align - 1) & ~(align - 1);
+    if(offset + size > REGION_CHUNK_SIZE)
+    {
+        chunkIndex ++;
+        if(chunkIndex == (int)chunks.size())
+        {
+            // operator new is aligned for any fundamental type, so is the start of each chunk
+            chunks.push_back((char*)::operator new(REGION_CHUNK_SIZE));
+        }
+        offset = 0;
+    }
+    chunkUsed = offset + size;
+    return chunks[chunkIndex] + offset;
+}
+
+/*
+ * Free all the objects, in reverse order of construction.
+ * The chunks are kept, so it's only as slow as the number of objects that have destructors.
+ */
+void Region::reset()
+{
+    for(int i = (int)destructors.size() - 1; i >= 0; i --)
+    {
+        destructors[i].destroy(destructors[i].object);
+    }
+    destructors.clear();
+    chunkIndex = -1;
+    chunkUsed = REGION_CHUNK_SIZE;
+}
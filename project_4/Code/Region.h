@@ -0,0 +1,56 @@
+#ifndef _REGION_H
+#define _REGION_H
+
+#include "common.h"
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/*
+ * Arena for the objects of one compilation, e.g. types, inter codes and the vars of the back end.
+ * Objects are bump-allocated from fixed-size chunks and freed all at once by reset(),
+ * which keeps the chunks for the next compilation, so a long-lived compiler stops allocating once it's warmed up.
+ * Objects that need their destructors called (those holding a string, a vector...) get them called by reset(),
+ * freeing the others costs nothing.
+ * Pointers handed out stay valid until reset() or the region is destroyed.
+ */
+#define REGION_CHUNK_SIZE 65536
+
+class Region
+{
+private:
+    struct Destructor
+    {
+        void (*destroy)(void *object);
+        void *object;
+    };
+
+    vector<char*> chunks;
+    int chunkIndex;     // chunk in use, chunks after it are kept by reset() for reuse
+    size_t chunkUsed;   // bytes used in the chunk in use
+    vector<Destructor> destructors;     // in order of construction
+
+    void* allocate(size_t size, size_t align);
+    template<class T>
+    static void destroy(void *object){ static_cast<T*>(object)->~T();}
+public:
+    Region();
+    ~Region();
+    /*
+     * Construct a T in the region, its destructor is left to reset().
+     */
+    template<class T, class... Args>
+    T* make(Args&&... args)
+    {
+        T *object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if(!std::is_trivially_destructible<T>::value)
+        {
+            destructors.push_back(Destructor{&destroy<T>, object});
+        }
+        return object;
+    }
+    void reset();
+};
+
+#endif
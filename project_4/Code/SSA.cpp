@@ -0,0 +1,398 @@
+#include "SSA.h"
+
+SSAConverter::SSAConverter(InterCodeTranslater& translater, IRCodes& unit)
+    : translater(translater), unit(unit)
+{
+}
+
+/*
+ * Codes no path from the entry reaches, e.g. those after a RETURN, would have no dominator.
+ */
+void SSAConverter::removeUnreachable()
+{
+    cfg.build(unit);
+    dominators.build(cfg);
+    bool removed = false;
+    for(int b = 0; b < cfg.getBlockNum(); b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        if(dominators.isReachable(b) || block.begin == block.end)
+        {
+            continue;
+        }
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            unit.remove(i);
+        }
+        removed = true;
+    }
+    if(removed)
+    {
+        unit.compact();
+        cfg.build(unit);
+        dominators.build(cfg);
+    }
+}
+
+void SSAConverter::findRenamable()
+{
+    renamable.assign(locations.size(), true);
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        const InterCode_ &code = unit.codes[i];
+        if(code.kind == DEC)
+        {
+            unordered_map<TableItem*, int>::const_iterator it = unit.variableIndexes.find(code.u.dec.tableItem_p);
+            if(it != unit.variableIndexes.end())
+            {
+                renamable[locations.getIndex(Operand::make(VARIABLE, it->second))] = false;
+            }
+            continue;
+        }
+        const Operand *uses[3];
+        int useNum = code.getUses(uses);
+        for(int j = 0; j < useNum; j ++)
+        {
+            if(uses[j]->kind() == ADDRESS)
+            {
+                int index = locations.getIndex(uses[j]->base());
+                if(index != -1)
+                {
+                    renamable[index] = false;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * A def of x needs a PHI for x in each block of its dominance frontier, which is a def of x in turn,
+ * so PHIs go in the iterated frontier of the blocks that set x. Where x is dead, the PHI is left out.
+ */
+void SSAConverter::placePhis(const Liveness& liveness)
+{
+    int blockNum = cfg.getBlockNum();
+    vector<vector<int> > defBlocks(locations.size());
+    for(int b = 0; b < blockNum; b ++)
+    {
+        const BasicBlock &block = cfg.getBlock(b);
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            const Operand *def = unit.codes[i].getDef();
+            if(def == NULL)
+            {
+                continue;
+            }
+            int index = locations.getIndex(*def);
+            if(renamable[index] && (defBlocks[index].empty() || defBlocks[index].back() != b))
+            {
+                defBlocks[index].push_back(b);
+            }
+        }
+    }
+
+    vector<vector<int> > blockPhis(blockNum);   // block -> locations of its PHIs
+    vector<int> phiMarks(blockNum, -1), defMarks(blockNum, -1);     // location last put there
+    for(int index = 0; index < locations.size(); index ++)
+    {
+        vector<int> worklist = defBlocks[index];
+        for(int i = 0; i < (int)worklist.size(); i ++)
+        {
+            defMarks[worklist[i]] = index;
+        }
+        while(!worklist.empty())
+        {
+            int b = worklist.back();
+            worklist.pop_back();
+            const vector<int> &frontier = dominators.getFrontier(b);
+            for(int i = 0; i < (int)frontier.size(); i ++)
+            {
+                int f = frontier[i];
+                if(phiMarks[f] == index)
+                {
+                    continue;
+                }
+                phiMarks[f] = index;
+                if(liveness.getIn(f).test(index))
+                {
+                    blockPhis[f].push_back(index);
+                }
+                if(defMarks[f] != index)
+                {
+                    defMarks[f] = index;
+                    worklist.push_back(f);
+                }
+            }
+        }
+    }
+
+    // right after the LABEL, the PHIs don't start blocks, so the blocks and the tree stay the same
+    vector<pair<int, InterCode_> > insertions;
+    for(int b = 0; b < blockNum; b ++)
+    {
+        if(blockPhis[b].empty())
+        {
+            continue;
+        }
+        const BasicBlock &block = cfg.getBlock(b);
+        int at = unit.codes[block.begin].kind == LABEL_DEC ? block.begin + 1 : block.begin;
+        for(int i = 0; i < (int)blockPhis[b].size(); i ++)
+        {
+            InterCode_ phi(PHI, locations.getOperand(blockPhis[b][i]), translater.newPhi());
+            insertions.push_back(make_pair(at, phi));
+        }
+    }
+    unit.insert(insertions);
+    cfg.build(unit);
+
+    phiLocations.assign(unit.codes.size(), -1);
+    for(int i = 0; i < (int)unit.codes.size(); i ++)
+    {
+        if(unit.codes[i].kind == PHI)
+        {
+            phiLocations[i] = locations.getIndex(unit.codes[i].u.phi.result);
+        }
+    }
+}
+
+void SSAConverter::renameUse(Operand *use)
+{
+    int index = locations.getIndex(*use);
+    if(index == -1 || !renamable[index])
+    {
+        return;
+    }
+    Operand name = names[index].back();
+    *use = use->kind() == DEREFER ? name.dereference() : name;
+}
+
+/*
+ * Walk the dominator tree, the value of x at a code is the one of the nearest def of x above it in the tree.
+ * Args of the PHIs of each succ are filled in at the end of the block.
+ */
+void SSAConverter::rename(int b)
+{
+    const BasicBlock &block = cfg.getBlock(b);
+    vector<int> pushed;
+    for(int i = block.begin; i < block.end; i ++)
+    {
+        InterCode_ &code = unit.codes[i];
+        if(code.kind != PHI)
+        {
+            Operand *uses[3];
+            int useNum = code.getUses(uses);
+            for(int j = 0; j < useNum; j ++)
+            {
+                renameUse(uses[j]);
+            }
+        }
+        Operand *def = code.getDef();
+        if(def == NULL || code.kind == PARAM)
+        {
+            continue;
+        }
+        int index = locations.getIndex(*def);
+        if(renamable[index])
+        {
+            *def = translater.newTemp();
+            names[index].push_back(*def);
+            pushed.push_back(index);
+        }
+    }
+
+    for(int s = 0; s < (int)block.succs.size(); s ++)
+    {
+        const BasicBlock &succ = cfg.getBlock(block.succs[s]);
+        for(int i = succ.begin; i < succ.end; i ++)
+        {
+            if(unit.codes[i].kind == PHI)
+            {
+                IRPhiArg arg = { block.end - 1, names[phiLocations[i]].back() };
+                unit.codes[i].u.phi.phi->args.push_back(arg);
+            }
+        }
+    }
+
+    const vector<int> &children = dominators.getChildren(b);
+    for(int i = 0; i < (int)children.size(); i ++)
+    {
+        rename(children[i]);
+    }
+    for(int i = 0; i < (int)pushed.size(); i ++)
+    {
+        names[pushed[i]].pop_back();
+    }
+}
+
+void SSAConverter::construct()
+{
+    removeUnreachable();
+    Liveness liveness;
+    liveness.analyse(cfg);
+    locations = liveness.getLocations();
+    findRenamable();
+    placePhis(liveness);
+
+    // a value read before any def is the one at the entry, under the old name
+    names.assign(locations.size(), vector<Operand>());
+    for(int index = 0; index < locations.size(); index ++)
+    {
+        names[index].push_back(locations.getOperand(index));
+    }
+    rename(cfg.getEntry());
+}
+
+/*
+ * copies are (to, from) pairs, to be done at once, each to set once.
+ * A copy is done when no other one still reads what it sets, and when all the copies left wait for each other,
+ * i.e. they are cycles like a := b, b := a, one of the values is saved in a new temp first.
+ */
+void SSAConverter::sequentialize(vector<pair<Operand, Operand> >& copies, vector<InterCode_>& codes)
+{
+    for(int i = 0; i < (int)copies.size(); i ++)
+    {
+        if(copies[i].first == copies[i].second)
+        {
+            copies.erase(copies.begin() + i --);
+        }
+    }
+    while(!copies.empty())
+    {
+        bool done = false;
+        for(int i = 0; i < (int)copies.size(); i ++)
+        {
+            bool read = false;
+            for(int j = 0; j < (int)copies.size() && !read; j ++)
+            {
+                read = copies[j].second == copies[i].first;
+            }
+            if(!read)
+            {
+                codes.push_back(InterCode_(ASSIGN, copies[i].first, copies[i].second));
+                copies.erase(copies.begin() + i --);
+                done = true;
+            }
+        }
+        if(!done)
+        {
+            Operand saved = copies[0].first;
+            Operand t = translater.newTemp();
+            codes.push_back(InterCode_(ASSIGN, t, saved));
+            for(int i = 0; i < (int)copies.size(); i ++)
+            {
+                if(copies[i].second == saved)
+                {
+                    copies[i].second = t;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Copies of the edge from P to the block S of a PHI go
+ *  before the GOTO that ends P,
+ *  at the start of S, before its LABEL, when P falls through to S,
+ *  in a block of their own for IF ... GOTO S, which is made to jump there instead,
+ *  put before S too, so the copies come before the codes that read them, as the back end expects.
+ * Args of edges that are gone, e.g. of preds removed by a pass, are dropped.
+ */
+void SSAConverter::destruct()
+{
+    cfg.build(unit);
+    vector<pair<int, InterCode_> > insertions;
+    for(int s = 0; s < cfg.getBlockNum(); s ++)
+    {
+        const BasicBlock &block = cfg.getBlock(s);
+        vector<int> phis;
+        for(int i = block.begin; i < block.end; i ++)
+        {
+            if(unit.codes[i].kind == PHI)
+            {
+                phis.push_back(i);
+            }
+        }
+        if(phis.empty())
+        {
+            continue;
+        }
+
+        Operand label = unit.codes[block.begin].u.sinop.op;
+        vector<InterCode_> fallCopies;
+        vector<InterCode_> splitBlocks;     // LABEL and copies of each edge block, after a GOTO S if need be
+        bool falls = false;     // whether control may go on past the codes before the edge block
+        for(int i = block.begin - 1; i >= 0; i --)
+        {
+            InterCodeKind kind = unit.codes[i].kind;
+            if(kind != NOP)
+            {
+                falls = kind != GOTO && kind != RETURN;
+                break;
+            }
+        }
+
+        for(int p = 0; p < (int)block.preds.size(); p ++)
+        {
+            const BasicBlock &pred = cfg.getBlock(block.preds[p]);
+            int last = pred.end - 1;
+            vector<pair<Operand, Operand> > copies;
+            for(int i = 0; i < (int)phis.size(); i ++)
+            {
+                const vector<IRPhiArg> &args = unit.codes[phis[i]].u.phi.phi->args;
+                for(int j = 0; j < (int)args.size(); j ++)
+                {
+                    if(args[j].pred == last)
+                    {
+                        copies.push_back(make_pair(unit.codes[phis[i]].u.phi.result, args[j].value));
+                        break;
+                    }
+                }
+            }
+            vector<InterCode_> codes;
+            sequentialize(copies, codes);
+            if(codes.empty())
+            {
+                continue;
+            }
+
+            const InterCode_ &lastCode = unit.codes[last];
+            if(lastCode.kind == GOTO)
+            {
+                for(int i = 0; i < (int)codes.size(); i ++)
+                {
+                    insertions.push_back(make_pair(last, codes[i]));
+                }
+                continue;
+            }
+            if(lastCode.kind == COND_GOTO && cfg.getLabelBlock(lastCode.u.condGoto->label) == s)
+            {
+                Operand edgeLabel = translater.newLabel();
+                lastCode.u.condGoto->label = edgeLabel;
+                if(falls)
+                {
+                    splitBlocks.push_back(InterCode_(GOTO, label));
+                }
+                splitBlocks.push_back(InterCode_(LABEL_DEC, edgeLabel));
+                splitBlocks.insert(splitBlocks.end(), codes.begin(), codes.end());
+                falls = true;
+            }
+            if(block.preds[p] + 1 == s)
+            {
+                fallCopies.insert(fallCopies.end(), codes.begin(), codes.end());
+            }
+        }
+
+        // fall through copies first, then the edge blocks, the last of which falls through to S
+        fallCopies.insert(fallCopies.end(), splitBlocks.begin(), splitBlocks.end());
+        for(int i = 0; i < (int)fallCopies.size(); i ++)
+        {
+            insertions.push_back(make_pair(block.begin, fallCopies[i]));
+        }
+        for(int i = 0; i < (int)phis.size(); i ++)
+        {
+            unit.remove(phis[i]);
+        }
+    }
+    unit.insert(insertions);
+    unit.compact();
+}
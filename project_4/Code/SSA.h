@@ -0,0 +1,45 @@
+#ifndef _SSA_H
+#define _SSA_H
+
+#include "common.h"
+#include <vector>
+#include "InterCode.h"
+#include "CFG.h"
+#include "Dataflow.h"
+
+/*
+ * Puts the codes of one function into static single assignment form, and back.
+ * In SSA form each variable and temp is set by one code only, so every use names the very value it reads:
+ * each def sets a new temp, and where different defs of a variable meet, a PHI at the start of the block
+ * picks the one of the edge control came along. PHIs are only placed where the variable is live.
+ * Variables DEC'd or whose address is taken live in memory and keep their names, and so do params,
+ * whose PARAM is their def at the entry. C-- has no global variables, so no callee sees a renamed one.
+ * Passes may work on the codes in SSA form, removing codes but not adding any, see IRPhi_.
+ * destruct() turns PHIs into copies at the end of the preds, splitting the edges of IF ... GOTO to a PHI's block,
+ * and the copies of an edge are ordered as if they were done at once, the swap problem of PHIs reading each other.
+ */
+class SSAConverter
+{
+private:
+    InterCodeTranslater &translater;    // for new temps, labels and PHIs
+    IRCodes &unit;
+    CFG cfg;
+    Dominators dominators;
+    Locations locations;
+    vector<bool> renamable;     // location -> whether it's put into SSA form
+    vector<int> phiLocations;   // code -> location its PHI is for, -1 for other codes
+    vector<vector<Operand> > names;     // location -> stack of its current values, while renaming
+
+    void removeUnreachable();
+    void findRenamable();
+    void placePhis(const Liveness& liveness);
+    void rename(int block);
+    void renameUse(Operand *use);
+    void sequentialize(vector<pair<Operand, Operand> >& copies, vector<InterCode_>& codes);
+public:
+    SSAConverter(InterCodeTranslater& translater, IRCodes& unit);
+    void construct();
+    void destruct();
+};
+
+#endif
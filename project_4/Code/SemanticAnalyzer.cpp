@@ -1,4 +1,6 @@
 #include "SemanticAnalyzer.h"
+#include <ctype.h>
+#include <string.h>
 
 // #define DEBUG
 static void showInfo(Node *node)
@@ -17,7 +19,16 @@ static void showInfo(Node *node)
 
 SemanticAnalyzer::SemanticAnalyzer()
 {
-    errorType->kind = ERROR;
+    errorType = symbolTable.getTypeContext()->getErrorType();
+    diagnostics = &cout;
+}
+
+/*
+ * Set where error messages go, cout by default.
+ */
+void SemanticAnalyzer::setDiagnostics(ostream* diagnostics)
+{
+    this->diagnostics = diagnostics;
 }
 
 SemanticErrorFlag SemanticAnalyzer::getSemanticErrorFlag()
@@ -32,10 +43,28 @@ SemanticErrorFlag SemanticAnalyzer::getSemanticErrorFlag()
  *  root of syntax tree, passed by syntax analyzer
  */
 void SemanticAnalyzer::analyse(Node* treeRoot)
+{
+    beginAnalysis();
+    Program(treeRoot);
+    endAnalysis();
+}
+
+/*
+ * Analyse a program one ExtDef at a time, for streaming compilation:
+ * beginAnalysis(), analyseExtDef() for each ExtDef in order, then endAnalysis().
+ * Every check only looks at what's defined before, so this finds the same errors as analyse().
+ */
+void SemanticAnalyzer::beginAnalysis()
 {
     symbolTable.clearTable();
     this->semanticErrorFlag = NO_SEMANTIC_ERROR;
-    Program(treeRoot);
+}
+void SemanticAnalyzer::analyseExtDef(Node* node)
+{
+    ExtDef(node);
+}
+void SemanticAnalyzer::endAnalysis()
+{
     checkUndefinedFunctions();
 }
 
@@ -133,7 +162,16 @@ TypeCompare SemanticAnalyzer::compareType(Type t1, Type t2)
     {
         return NOT_MATCH;
     }
+    if(t1->canonical == t2->canonical)
+    {
+        return MATCH;
+    }
+    if(!t1->hasError && !t2->hasError)
+    {
+        return NOT_MATCH;
+    }
 
+    // the error type inside may match anything, compare part by part
     switch(t1->kind)
     {
         case BASIC:
@@ -146,7 +184,7 @@ TypeCompare SemanticAnalyzer::compareType(Type t1, Type t2)
         case FUNCTION:
             // It shouldn't really happend where we need to compare two functions in this method.
             // Simply check for name now.
-            return t1->u.function->name.compare(t2->u.function->name) == 0 ? MATCH : NOT_MATCH;
+            return t1->u.function->symbol == t2->u.function->symbol ? MATCH : NOT_MATCH;
         default: return NOT_SET;
     }
 }
@@ -164,7 +202,7 @@ bool SemanticAnalyzer::matchedStructure(Structure s1, Structure s2)
  */
 AddFunctionResult SemanticAnalyzer::checkAndAddFunction(Function function)
 {
-    TableItem *item = symbolTable.getItemByName(function->name);
+    TableItem *item = symbolTable.getItemBySymbol(function->symbol);
     if(item == NULL)
     {
         // add a new item to symbol table.
@@ -209,22 +247,22 @@ void SemanticAnalyzer::dealWithAddFunctionResult(AddFunctionResult result, int l
     switch(result)
     {
         case REDEFINED:
-            cout << "Error type 4 at line " << lineno
+            *diagnostics << "Error type 4 at line " << lineno
                     << ": Redefined function \"" << function->name << "\"." << endl;
             this->semanticErrorFlag = SEMANTIC_ERROR;
             return;
         case DIFFERENT_KIND:
-            cout << "Error type 19 at line " << lineno
+            *diagnostics << "Error type 19 at line " << lineno
                     << ": \"" << function->name << "\" redeclared as different kind of symbol." << endl;
             this->semanticErrorFlag = SEMANTIC_ERROR;
             return;
         case INCONSISTENT_DECLARE:
-            cout << "Error type 19 at line " << lineno
+            *diagnostics << "Error type 19 at line " << lineno
                     << ": Inconsistent declaration of function \"" << function->name << "\"." << endl;
             this->semanticErrorFlag = SEMANTIC_ERROR;
             return;
         case INCONSISTENT_DEFINE:
-            cout << "Error type 19 at line " << lineno
+            *diagnostics << "Error type 19 at line " << lineno
                     << ": Inconsistent definition of function \"" << function->name << "\"." << endl;
             this->semanticErrorFlag = SEMANTIC_ERROR;
             return;
@@ -244,7 +282,7 @@ void SemanticAnalyzer::dealWithAddFunctionResult(AddFunctionResult result, int l
         {
             FunDecRecord record;
             record.lineno = lineno;
-            record.function = symbolTable.getItemByName(function->name)->type->u.function; // function in table
+            record.function = symbolTable.getItemBySymbol(function->symbol)->type->u.function; // function in table
             symbolTable.funDecRecords.push_back(record);
         }
         default: return;
@@ -257,7 +295,7 @@ void SemanticAnalyzer::checkUndefinedFunctions()
     {
         if(!(*it).function->isDefined)
         {
-            cout << "Error type 18 at line " << (*it).lineno 
+            *diagnostics << "Error type 18 at line " << (*it).lineno 
                 << ": Undefined function \"" << (*it).function->name << "\"." << endl;
             this->semanticErrorFlag = SEMANTIC_ERROR;
         }
@@ -272,7 +310,6 @@ SymbolTable* SemanticAnalyzer::getSymbolTable()
 /********************** End of Tool Functions *************************/
 
 /************************ Semantic Actions ****************************/
-//TODO: free space of Type_() for temporary types
 //TODO: add variable type
 /* High-level Definitions */
 void SemanticAnalyzer::Program(Node* node)
@@ -290,9 +327,9 @@ void SemanticAnalyzer::ExtDefList(Node* node)
         // ExtDefList -> $empty
         return;
     }
-    // ExtDefList -> ExtDef ExtDefList
-    ExtDef(node->getChild(0));
-    ExtDefList(node->getChild(1));
+    // ExtDefList -> ExtDefList ExtDef
+    ExtDefList(node->getChild(0));
+    ExtDef(node->getChild(1));
 }
 
 void SemanticAnalyzer::ExtDef(Node* node)
@@ -372,28 +409,22 @@ void SemanticAnalyzer::ExtDecList(Node* node, Type type)
 Type SemanticAnalyzer::Specifier(Node* node)
 {
     showInfo(node);
-    Type type = new Type_();
-    type->assignType = LEFT;
     switch(node->getProductionNo())
     {
         case 0:
             //Specifier -> TYPE
-            type->kind = BASIC;
             if(node->getChild(0)->getText().compare("int") == 0){
-                type->u.basic = INT;
+                return symbolTable.getTypeContext()->getBasicType(INT);
             } else if(node->getChild(0)->getText().compare("float") == 0){
-                type->u.basic = FLOAT;
+                return symbolTable.getTypeContext()->getBasicType(FLOAT);
             } else {
                 return errorType;
             }
-            break;
         case 1:
             //Specifier -> StructSpecifier
-            type = StructSpecifier(node->getChild(0));
-            break;
+            return StructSpecifier(node->getChild(0));
         default: return errorType;
     }
-    return type;
 }
 
 Type SemanticAnalyzer::StructSpecifier(Node* node)
@@ -404,20 +435,21 @@ Type SemanticAnalyzer::StructSpecifier(Node* node)
         case 0:
         {
             //StructSpecifier -> STRUCT OptTag LC DefList RC
-            string structureName = OptTag(node->getChild(1));
-            if(structureName.compare("") != 0 && symbolTable.isDuplicatedNameInCurrentScope(structureName))
+            Symbol structureSymbol = OptTag(node->getChild(0));
+            if(structureSymbol != SYMBOL_EMPTY && symbolTable.isDuplicatedNameInCurrentScope(structureSymbol))
             {
-                cout << "Error type 16 at line " << node->getChild(1)->getLineno()
-                        << ": Duplicated name \"" << structureName << "\"." << endl;
+                *diagnostics << "Error type 16 at line " << node->getChild(0)->getLineno()
+                        << ": Duplicated name \"" << node->getChild(0)->getText() << "\"." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
-            Structure structure = new Structure_();
-            structure->name = structureName;
+            Structure structure = symbolTable.getTypeContext()->newStructure();
+            structure->name = (structureSymbol == SYMBOL_EMPTY) ? "" : node->getChild(0)->getText();
+            structure->symbol = structureSymbol;
 
             // EnterScopeNote: Var declarations in struct definition are in a scope.
             symbolTable.enterScope(STRUCT);
-            structure->structureFieldList = DefList(node->getChild(3));
+            structure->structureFieldList = DefList(node->getChild(1));
             symbolTable.exitScope();
 
             // for ananymous struct, simply add it to symbol table with name ""
@@ -428,12 +460,11 @@ Type SemanticAnalyzer::StructSpecifier(Node* node)
         case 1:
         {
             //StructSpecifier -> STRUCT Tag
-            string tag = Tag(node->getChild(1));
-            TableItem *item = symbolTable.getItemByName(tag);
+            TableItem *item = symbolTable.getItemBySymbol(Tag(node->getChild(0)));
             if(item == NULL || item->type == NULL || item->type->kind != STRUCTURE)
             {
-                cout << "Error type 17 at line " << node->getChild(1)->getLineno() 
-                    << ": Undefined structure \"" << tag << "\"." << endl;
+                *diagnostics << "Error type 17 at line " << node->getChild(0)->getLineno() 
+                    << ": Undefined structure \"" << node->getChild(0)->getText() << "\"." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
@@ -446,27 +477,27 @@ Type SemanticAnalyzer::StructSpecifier(Node* node)
     }
 }
 
-string SemanticAnalyzer::OptTag(Node* node)
+Symbol SemanticAnalyzer::OptTag(Node* node)
 {
     showInfo(node);
     if(node == NULL)
     {
         //OptTag -> $empty
-        return "";
+        return SYMBOL_EMPTY;
     }
     else 
     {
         //OptTag -> ID
-        return node->getText();
+        return node->getChild(0)->getSymbol();
     }
     
 }
 
-string SemanticAnalyzer::Tag(Node* node)
+Symbol SemanticAnalyzer::Tag(Node* node)
 {
     showInfo(node);
     //Tag -> ID
-    return node->getText();
+    return node->getChild(0)->getSymbol();
 }
 
 /* Declarators */
@@ -478,17 +509,18 @@ FieldList SemanticAnalyzer::VarDec(Node* node, Type type, bool fromParam)
         case 0:
         {
             //VarDec -> ID
-            string name = node->getChild(0)->getText();
-            if(symbolTable.isDuplicatedNameInCurrentScope(name))
+            Symbol symbol = node->getChild(0)->getSymbol();
+            if(symbolTable.isDuplicatedNameInCurrentScope(symbol))
             {
+                string name = node->getChild(0)->getText();
                 if(symbolTable.getScopeType() == STRUCT)
                 {   
-                    cout << "Error type 15 at line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 15 at line " << node->getChild(0)->getLineno()
                         << ": Redefined field \"" << name << "\"." << endl;
                 }
                 else
                 {
-                    cout << "Error type 3 at line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 3 at line " << node->getChild(0)->getLineno()
                             << ": Redefined variable \"" << name << "\"." << endl;
                 }
                 this->semanticErrorFlag = SEMANTIC_ERROR;
@@ -496,19 +528,14 @@ FieldList SemanticAnalyzer::VarDec(Node* node, Type type, bool fromParam)
             }
             else 
             {
-                FieldList varDec = new FieldList_();
-                varDec->name = node->getChild(0)->getText();
+                FieldList varDec = symbolTable.getTypeContext()->newFieldList();
+                varDec->name = node->getChild(0)->getValue();
+                varDec->symbol = symbol;
                 varDec->type = type;
                 varDec->tail = NULL;
                 // for array/struct parameter, its address is passed, so the symbol is actually a pointer 
-                if(fromParam && (type->kind == ARRAY || type->kind == STRUCTURE))
-                {
-                    symbolTable.addFieldList(varDec, true);
-                }
-                else
-                {
-                    symbolTable.addFieldList(varDec, false);
-                }
+                bool isPointer = fromParam && (type->kind == ARRAY || type->kind == STRUCTURE);
+                node->getChild(0)->setItem(symbolTable.addFieldList(varDec, isPointer));
                 return varDec;
             }
             break;
@@ -516,11 +543,7 @@ FieldList SemanticAnalyzer::VarDec(Node* node, Type type, bool fromParam)
         case 1:
         {
             //VarDec -> VarDec LB INT RB
-            Type varDec = new Type_();
-            varDec->assignType = LEFT;
-            varDec->kind = ARRAY;
-            varDec->u.array.size = node->getChild(2)->getIntValue();
-            varDec->u.array.elem = type;
+            Type varDec = symbolTable.getTypeContext()->getArrayType(type, node->getChild(1)->getIntValue());
             return VarDec(node->getChild(0), varDec, fromParam);
             break;
         }
@@ -531,14 +554,14 @@ FieldList SemanticAnalyzer::VarDec(Node* node, Type type, bool fromParam)
 Function SemanticAnalyzer::FunDec(Node* node, Type retType)
 {
     showInfo(node);
-    Function function = new Function_();
-    function->name = node->getChild(0)->getText();
+    Function function = symbolTable.getTypeContext()->newFunction();
+    function->name = node->getChild(0)->getValue();
+    function->symbol = node->getChild(0)->getSymbol();
     function->returnType = retType;
-    function->returnType->assignType = RIGHT;
     if(node->getProductionNo() == 0)
     {
         //FunDec -> ID LP VarList RP
-        function->params = VarList(node->getChild(2));
+        function->params = VarList(node->getChild(1));
     }
     else 
     {
@@ -556,7 +579,7 @@ FieldList SemanticAnalyzer::VarList(Node* node)
     if(node->getProductionNo() == 0)
     {
         //VarList -> ParamDec COMMA VarList
-        varList->tail = VarList(node->getChild(2));
+        varList->tail = VarList(node->getChild(1));
     }
 
     return varList;
@@ -581,8 +604,8 @@ void SemanticAnalyzer::CompSt(Node* node, Type retType)
      */
     showInfo(node);
     //CompSt -> LC DefList StmtList RC
-    DefList(node->getChild(1));
-    StmtList(node->getChild(2), retType);
+    DefList(node->getChild(0));
+    StmtList(node->getChild(1), retType);
 }
 
 void SemanticAnalyzer::StmtList(Node* node, Type retType)
@@ -617,10 +640,10 @@ void SemanticAnalyzer::Stmt(Node* node, Type retType)
         case 2:
         {
             //Stmt -> RETURN Exp SEMI
-            Type resultType = Exp(node->getChild(1));
+            Type resultType = Exp(node->getChild(0)).type;
             if(compareType(resultType, retType) == NOT_MATCH)
             {
-                cout << "Error type 8 at line " << node->getChild(1)->getLineno()
+                *diagnostics << "Error type 8 at line " << node->getChild(0)->getLineno()
                         << ": Type mismatched for return." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
             }
@@ -629,23 +652,23 @@ void SemanticAnalyzer::Stmt(Node* node, Type retType)
         case 3:
         {
             //Stmt -> IF LP Exp RP Stmt
-            Type expType = Exp(node->getChild(2));
-            Stmt(node->getChild(4), retType);
+            Exp(node->getChild(0));
+            Stmt(node->getChild(1), retType);
             break;
         }
         case 4:
         {
             //Stmt -> IF LP Exp RP Stmt ELSE Stmt
-            Type expType = Exp(node->getChild(2));
-            Stmt(node->getChild(4), retType);
-            Stmt(node->getChild(6), retType);
+            Exp(node->getChild(0));
+            Stmt(node->getChild(1), retType);
+            Stmt(node->getChild(2), retType);
             break;
         }
         case 5:
         {
             //Stmt -> WHILE LP Exp RP Stmt
-            Exp(node->getChild(2));
-            Stmt(node->getChild(4), retType);
+            Exp(node->getChild(0));
+            Stmt(node->getChild(1), retType);
             break;
         }
         default: return;
@@ -700,7 +723,7 @@ FieldList SemanticAnalyzer::DecList(Node* node, Type type)
     }
 
     //DecList -> Dec COMMA DecList
-    FieldList decList = DecList(node->getChild(2), type);
+    FieldList decList = DecList(node->getChild(1), type);
     if(dec == NULL)
     {
         return decList;
@@ -728,10 +751,10 @@ FieldList SemanticAnalyzer::Dec(Node* node, Type type)
         return varDec;
     }
 	//Dec -> VarDec ASSIGNOP Exp
-    Type expType = Exp(node->getChild(2));
+    Type expType = Exp(node->getChild(1)).type;
     if(compareType(type, expType) == NOT_MATCH)
     {
-        cout << "Error type 5 at Line " << node->getChild(1)->getLineno()
+        *diagnostics << "Error type 5 at Line " << node->getLineno()
                 << ": Type mismatched for assignment." << endl;
         this->semanticErrorFlag = SEMANTIC_ERROR;
         return NULL;
@@ -740,7 +763,75 @@ FieldList SemanticAnalyzer::Dec(Node* node, Type type)
 }
 
 /* Expressions */
-Type SemanticAnalyzer::Exp(Node* node)
+/*
+ * Text of the index of Exp -> Exp LB Exp RB for diagnostics, the terminals joined as in the source.
+ * The tree keeps no operators or parentheses, so the text is taken from the source buffer the leaves point into,
+ * from the LB before the first terminal of index to the RB that matches it, leaving out spaces and comments.
+ */
+static string indexText(Node* index)
+{
+    Node *first = index;
+    while(first->getChildNum() > 0 && first->getChild(0) != NULL)
+    {
+        first = first->getChild(0);
+    }
+    const char *p = first->getTextPtr();
+    if(p == NULL)
+    {
+        return index->getText();
+    }
+    // only '(', '-', '!', spaces and comments come between LB and the first terminal
+    while(*(p - 1) != '[')
+    {
+        p --;
+    }
+    string text;
+    int depth = 0;
+    for(; *p != '\0'; p ++)
+    {
+        if(p[0] == '/' && p[1] == '*')
+        {
+            const char *end = strstr(p + 2, "*/");
+            if(end == NULL)
+            {
+                break;
+            }
+            p = end + 1;
+        }
+        else if(p[0] == '/' && p[1] == '/')
+        {
+            while(p[1] != '\0' && p[1] != '\n')
+            {
+                p ++;
+            }
+        }
+        else if(!isspace((unsigned char)*p))
+        {
+            if(*p == '[')
+            {
+                depth ++;
+            }
+            else if(*p == ']' && depth -- == 0)
+            {
+                break;
+            }
+            text += *p;
+        }
+    }
+    return text;
+}
+
+/*
+ * Check an Exp and keep its type on the node for later passes.
+ */
+ExpType SemanticAnalyzer::Exp(Node* node)
+{
+    ExpType expType = checkExp(node);
+    node->setType(expType.type);
+    return expType;
+}
+
+ExpType SemanticAnalyzer::checkExp(Node* node)
 {
     showInfo(node);
     switch(node->getProductionNo())
@@ -748,17 +839,17 @@ Type SemanticAnalyzer::Exp(Node* node)
         case 0:
         {
             //Exp -> Exp ASSIGNOP Exp
-            Type tLeft = Exp(node->getChild(0)), tRight = Exp(node->getChild(2));
-            if(tLeft->assignType == RIGHT)
+            ExpType tLeft = Exp(node->getChild(0)), tRight = Exp(node->getChild(1));
+            if(tLeft.assignType == RIGHT)
             {
-                cout << "Error type 6 at Line " << node->getChild(0)->getLineno()
+                *diagnostics << "Error type 6 at Line " << node->getChild(0)->getLineno()
                         << ": The left-hand side of an assignment must be a variable." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
-            if(compareType(tLeft, tRight) == NOT_MATCH)
+            if(compareType(tLeft.type, tRight.type) == NOT_MATCH)
             {
-                cout << "Error type 5 at Line " << node->getChild(0)->getLineno()
+                *diagnostics << "Error type 5 at Line " << node->getChild(0)->getLineno()
                         << ": Type mismatched for assignment." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
@@ -784,68 +875,54 @@ Type SemanticAnalyzer::Exp(Node* node)
         {
             //Exp -> Exp DIV Exp
             //case 1-7 share the same actions
-            Type tLeft = Exp(node->getChild(0)), tRight = Exp(node->getChild(2));
+            Type tLeft = Exp(node->getChild(0)).type, tRight = Exp(node->getChild(1)).type;
             if(tLeft->kind == BASIC && tRight->kind == BASIC && tLeft->u.basic == tRight->u.basic)
             {
-                Type retType = new Type_();
-                retType->kind =  BASIC;
-                retType->u.basic = tLeft->u.basic;
-                retType->assignType = RIGHT;
-                return retType;
+                return ExpType(tLeft, RIGHT);
             }
             else
             {
                 if(compareType(tLeft, tRight) == NOT_MATCH)
                 {
-                    cout << "Error type 7 at Line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 7 at Line " << node->getChild(0)->getLineno()
                             << ": Type mismatched for operands." << endl;
                     this->semanticErrorFlag = SEMANTIC_ERROR;
                 }
                 return errorType;
             }
         }
-        case 8:
-            //Exp -> LP Exp RP
-            return Exp(node->getChild(1));
+        //case 8: Exp -> LP Exp RP is replaced by the inner Exp when building the tree
         case 9:
         {
             //Exp -> MINUS Exp
-            Type typeExp = Exp(node->getChild(1));
+            Type typeExp = Exp(node->getChild(0)).type;
             if(typeExp->kind != BASIC) 
             {
                 if(typeExp->kind != ERROR) // don't consider error type as Error type 7
                 {
-                    cout << "Error type 7 at Line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 7 at Line " << node->getLineno()
                             << ": Type mismatched for operands." << endl;
                     this->semanticErrorFlag = SEMANTIC_ERROR;
                 }
                 return errorType;
             }
-            Type retType = new Type_();
-            retType->kind =  BASIC;
-            retType->u.basic = typeExp->u.basic;
-            retType->assignType = RIGHT;
-            return retType;
+            return ExpType(typeExp, RIGHT);
         }
         case 10:
         {
             //Exp -> NOT Exp
-            Type typeExp = Exp(node->getChild(1));
+            Type typeExp = Exp(node->getChild(0)).type;
             if(typeExp->kind != BASIC || typeExp->u.basic != INT)
             {
                 if(typeExp->kind != ERROR) // don't consider error type as Error type 7
                 {
-                    cout << "Error type 7 at Line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 7 at Line " << node->getLineno()
                             << ": Type mismatched for operands." << endl;
                     this->semanticErrorFlag = SEMANTIC_ERROR;
                 }
                 return errorType;
             }
-            Type retType = new Type_();
-            retType->kind =  BASIC;
-            retType->u.basic = typeExp->u.basic;
-            retType->assignType = RIGHT;
-            return retType;
+            return ExpType(typeExp, RIGHT);
         }
         case 11:
             //Exp -> ID LP Args RP
@@ -853,23 +930,29 @@ Type SemanticAnalyzer::Exp(Node* node)
         {
             //Exp -> ID LP RP
             // case 11-12 share some same actions
-            string functionName = node->getChild(0)->getText();
-            TableItem *item = symbolTable.getItemByName(functionName);
+            Symbol functionSymbol = node->getChild(0)->getSymbol();
+            TableItem *item = symbolTable.getItemBySymbol(functionSymbol);
+            node->getChild(0)->setItem(item);
             Type function = item ? item->type : NULL;
             if(function == NULL)
             {
-                if(!(functionName.compare("read") == 0 || functionName.compare("write") == 0))
+                if(!(functionSymbol == SYMBOL_READ || functionSymbol == SYMBOL_WRITE))
                 {
-                    cout << "Error type 2 at Line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 2 at Line " << node->getChild(0)->getLineno()
                             << ": Undefined function \"" << node->getChild(0)->getText() << "\"." << endl;
                     this->semanticErrorFlag = SEMANTIC_ERROR;
+                }
+                else if(node->getProductionNo() == 11)
+                {
+                    // args of write are checked as well, inter codes need their nodes annotated
+                    Args(node->getChild(1));
                 }
                  // read and write have no return type, treated as errorType
                 return errorType;
             }
             if(function->kind != FUNCTION)
             {
-                cout << "Error type 11 at Line " << node->getChild(0)->getLineno()
+                *diagnostics << "Error type 11 at Line " << node->getChild(0)->getLineno()
                         << ": \"" << node->getChild(0)->getText() << "\" is not a function." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
@@ -883,7 +966,7 @@ Type SemanticAnalyzer::Exp(Node* node)
                 //Exp -> ID LP RP
                 if(param != NULL)
                 {
-                    cout << "Error type 9 at Line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 9 at Line " << node->getChild(0)->getLineno()
                         << ": Function \"" << node->getChild(0)->getText() << "\" is not applicable for arguments." << endl;
                     this->semanticErrorFlag = SEMANTIC_ERROR;
                     return errorType;
@@ -892,115 +975,87 @@ Type SemanticAnalyzer::Exp(Node* node)
             else
             {
                 //Exp -> ID LP Args RP
-                FieldList tmpArgs = Args(node->getChild(2));
+                FieldList tmpArgs = Args(node->getChild(1));
                 if(!matchedFieldlist(tmpArgs, param))
                 {
-                    cout << "Error type 9 at Line " << node->getChild(0)->getLineno()
+                    *diagnostics << "Error type 9 at Line " << node->getChild(0)->getLineno()
                         << ": Function \"" << node->getChild(0)->getText() << "(" << toString(param) << ")"
                         << "\" is not applicable for arguments \"(" << toString(tmpArgs) << ")\"." << endl;
                     this->semanticErrorFlag = SEMANTIC_ERROR;
-                    // tmpArgs won't be added to symbol table, delete it in time
-                    delete tmpArgs;
-                    tmpArgs = NULL;
                     return errorType;
                 }
-                // tmpArgs won't be added to symbol table, delete it in time
-                delete tmpArgs;
-                tmpArgs = NULL;
+                // tmpArgs are freed with the types, when the table is cleared
             }
-            Type retType = new Type_();
-            retType->kind = function->u.function->returnType->kind;
-            retType->u = function->u.function->returnType->u;
-            retType->assignType = RIGHT;
-            return retType;
+            return ExpType(function->u.function->returnType, RIGHT);
         }
         case 13:
         {
             //Exp -> Exp LB Exp RB
-            Type arrayType = Exp(node->getChild(0));
+            Type arrayType = Exp(node->getChild(0)).type;
             if(arrayType->kind != ARRAY)
             {
-                cout << "Error type 10 at Line " << node->getChild(0)->getLineno()
+                *diagnostics << "Error type 10 at Line " << node->getChild(0)->getLineno()
                         << ": \"" << node->getChild(0)->getText() << "\" is not an array." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
-            Type indexType = Exp(node->getChild(2));
+            Type indexType = Exp(node->getChild(1)).type;
             if(!(indexType->kind == BASIC && indexType->u.basic == INT))
             {
-                cout << "Error type 12 at Line " << node->getChild(0)->getLineno()
-                        << ": \"" << node->getChild(2)->getText() << "\" is not an integer." << endl;
+                *diagnostics << "Error type 12 at Line " << node->getChild(0)->getLineno()
+                        << ": \"" << indexText(node->getChild(1)) << "\" is not an integer." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
-            Type retType = new Type_();
-            retType->kind = arrayType->u.array.elem->kind;
-            retType->u = arrayType->u.array.elem->u;
-            retType->assignType = LEFT;
-            return retType;
+            return ExpType(arrayType->u.array.elem, LEFT);
         }
         case 14:
         {
             //Exp -> Exp DOT ID
-            Type structType = Exp(node->getChild(0));
+            Type structType = Exp(node->getChild(0)).type;
             if(structType->kind != STRUCTURE)
             {
-                cout << "Error type 13 at Line " << node->getChild(0)->getLineno()
+                *diagnostics << "Error type 13 at Line " << node->getChild(0)->getLineno()
                         << ": Illegal use of \".\"." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
 
             // search for ID in this struct
-            string IDName = node->getChild(2)->getText();
-            FieldList itr = structType->u.structure->structureFieldList;
-            while(itr)
+            FieldLayout *field = structType->u.structure->layout->getField(node->getChild(1)->getSymbol());
+            if(field != NULL)
             {
-                if(itr->name.compare(IDName) == 0)
-                {
-                    Type retType = new Type_();
-                    retType->kind = itr->type->kind;
-                    retType->u = itr->type->u;
-                    retType->assignType = LEFT;
-                    return retType;
-                }
-                itr = itr->tail;
+                return ExpType(field->type, LEFT);
             }
-            cout << "Error type 14 at Line " << node->getChild(0)->getLineno()
-                        << ": Non-existent field \"" << IDName << "\"." << endl;
+            *diagnostics << "Error type 14 at Line " << node->getChild(0)->getLineno()
+                        << ": Non-existent field \"" << node->getChild(1)->getText() << "\"." << endl;
             this->semanticErrorFlag = SEMANTIC_ERROR;
             return errorType;
         }
         case 15:
         {
             //Exp -> ID
-            TableItem *IDItem = symbolTable.getItemByName(node->getChild(0)->getText());
+            TableItem *IDItem = symbolTable.getItemBySymbol(node->getChild(0)->getSymbol());
+            node->getChild(0)->setItem(IDItem);
             if(IDItem == NULL || IDItem->type == NULL)
             {
-                cout << "Error type 1 at Line " << node->getChild(0)->getLineno()
+                *diagnostics << "Error type 1 at Line " << node->getChild(0)->getLineno()
                         << ": Undefined variable \"" << node->getChild(0)->getText() << "\"." << endl;
                 this->semanticErrorFlag = SEMANTIC_ERROR;
                 return errorType;
             }
-            return IDItem->type;
+            // a function can't be assigned to
+            return ExpType(IDItem->type, IDItem->type->kind == FUNCTION ? RIGHT : LEFT);
         }
         case 16:
         {    
             //Exp -> INT
-            Type type = new Type_();
-            type->kind = BASIC;
-            type->u.basic = INT;
-            type->assignType = RIGHT;
-            return type;
+            return ExpType(symbolTable.getTypeContext()->getBasicType(INT), RIGHT);
         }
         case 17:
         {
             //Exp -> FLOAT
-            Type type = new Type_();
-            type->kind = BASIC;
-            type->u.basic = FLOAT;
-            type->assignType = RIGHT;
-            return type;
+            return ExpType(symbolTable.getTypeContext()->getBasicType(FLOAT), RIGHT);
         }
     }
 }
@@ -1008,14 +1063,13 @@ Type SemanticAnalyzer::Exp(Node* node)
 FieldList SemanticAnalyzer::Args(Node* node)
 {
     showInfo(node);
-    FieldList args = new FieldList_();
+    FieldList args = symbolTable.getTypeContext()->newFieldList();
 	//Exp
-    Type expType = Exp(node->getChild(0));
-    args->type = expType;
+    args->type = Exp(node->getChild(0)).type;
     if(node->getProductionNo() == 0)
     {
         //Exp COMMA Args
-        args->tail = Args(node->getChild(2));
+        args->tail = Args(node->getChild(1));
     }
     return args;
 }
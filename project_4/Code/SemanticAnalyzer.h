@@ -11,12 +11,26 @@ enum AddFunctionResult  {   NEW_DEC_ADDED, NEW_DEF_ADDED, DIFFERENT_KIND, REDEFI
                             NEWLY_DEFINED, INCONSISTENT_DEFINE};
 enum SemanticErrorFlag  {   NO_SEMANTIC_ERROR, SEMANTIC_ERROR};
 
+/*
+ * Type of an expression, and whether it's a left value.
+ * Types are shared, so whether an expression can be assigned to is kept out of them.
+ */
+struct ExpType
+{
+    Type type;
+    AssignType assignType;
+    // the error type is a left value, so no more error is reported for assigning to it
+    ExpType(Type type){ this->type = type; this->assignType = LEFT;}
+    ExpType(Type type, AssignType assignType){ this->type = type; this->assignType = assignType;}
+};
+
 class SemanticAnalyzer
 {
 private:
     SemanticErrorFlag semanticErrorFlag;
     SymbolTable symbolTable;
-    const Type errorType = new Type_();
+    ostream* diagnostics;   // error messages
+    Type errorType;
 
     /**************************** Tool Functions ***************************/
     string toString(FieldList fieldList);
@@ -27,12 +41,17 @@ private:
     AddFunctionResult checkAndAddFunction(Function function);
     void dealWithAddFunctionResult(AddFunctionResult result, int lineno, Function function);
     void checkUndefinedFunctions();
+    ExpType checkExp(Node* node);
     /************************* End of Tool Functions ***********************/
     
 public:
     SemanticAnalyzer();
     SemanticErrorFlag getSemanticErrorFlag();
+    void setDiagnostics(ostream* diagnostics);
     void analyse(Node* treeRoot);
+    void beginAnalysis();
+    void analyseExtDef(Node* node);
+    void endAnalysis();
     bool functionAllDefined();
     SymbolTable* getSymbolTable();
 
@@ -47,8 +66,8 @@ public:
     /* Specifiers */
     Type Specifier(Node* node);
     Type StructSpecifier(Node* node);
-    string OptTag(Node* node);
-    string Tag(Node* node);
+    Symbol OptTag(Node* node);
+    Symbol Tag(Node* node);
 
     /* Declarators */
     FieldList VarDec(Node* node, Type type, bool fromParam);
@@ -68,7 +87,7 @@ public:
     FieldList Dec(Node* node, Type type);
 
     /* Expressions */
-    Type Exp(Node* node);
+    ExpType Exp(Node* node);
     FieldList Args(Node* node);
 
     /*********************** End of Semantic Actions ***********************/
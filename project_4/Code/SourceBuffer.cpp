@@ -0,0 +1,151 @@
+#include "SourceBuffer.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceBuffer::SourceBuffer()
+{
+    data = NULL;
+    size = 0;
+    mappedSize = 0;
+}
+
+SourceBuffer::~SourceBuffer()
+{
+    close();
+}
+
+/*
+ * Load a source file.
+ * @return
+ *  false if the file can't be opened or read, errno is set.
+ */
+bool SourceBuffer::open(const char *path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+    bool ok = mapFile(fd) || readFile(fd);
+    ::close(fd);
+    return ok;
+}
+
+/*
+ * Make an empty buffer of 'size' bytes for a source that's not in a file,
+ * the caller fills it in, e.g. straight from a socket.
+ * @return
+ *  NULL if out of memory.
+ */
+char* SourceBuffer::allocate(size_t size)
+{
+    close();
+    char *buffer = (char*)malloc(size + 2);
+    if(buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer[size] = buffer[size + 1] = '\0';
+    data = buffer;
+    this->size = size;
+    mappedSize = 0;
+    return buffer;
+}
+
+void SourceBuffer::close()
+{
+    if(data != NULL)
+    {
+        if(mappedSize > 0)
+        {
+            munmap(data, mappedSize);
+        }
+        else
+        {
+            free(data);
+        }
+    }
+    data = NULL;
+    size = 0;
+    mappedSize = 0;
+}
+
+/*
+ * Map a regular file.
+ * Reserve size + 2 bytes of zeroed anonymous memory first, then map the file over the beginning of it,
+ * so the two bytes after the end of file are always NUL, whether or not the file ends on a page boundary.
+ * The mapping is private and writable, as flex writes into the buffer while scanning.
+ */
+bool SourceBuffer::mapFile(int fd)
+{
+    struct stat st;
+    if(fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        return false;
+    }
+    size_t fileSize = st.st_size;
+    size_t total = fileSize + 2;
+    void *base = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED)
+    {
+        return false;
+    }
+    if(mmap(base, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(base, total);
+        return false;
+    }
+    data = (char*)base;
+    size = fileSize;
+    mappedSize = total;
+    return true;
+}
+
+/*
+ * Read the whole file into a heap buffer, for pipes and files that can't be mapped.
+ */
+bool SourceBuffer::readFile(int fd)
+{
+    size_t capacity = 4096;
+    size_t used = 0;
+    char *buffer = (char*)malloc(capacity);
+    if(buffer == NULL)
+    {
+        return false;
+    }
+    while(true)
+    {
+        if(used + 2 >= capacity)
+        {
+            capacity *= 2;
+            char *larger = (char*)realloc(buffer, capacity);
+            if(larger == NULL)
+            {
+                free(buffer);
+                return false;
+            }
+            buffer = larger;
+        }
+        ssize_t n = read(fd, buffer + used, capacity - used - 2);
+        if(n < 0)
+        {
+            free(buffer);
+            return false;
+        }
+        if(n == 0)
+        {
+            break;
+        }
+        used += n;
+    }
+    buffer[used] = buffer[used + 1] = '\0';
+    data = buffer;
+    size = used;
+    mappedSize = 0;
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef _SOURCEBUFFER_H
+#define _SOURCEBUFFER_H
+
+#include "common.h"
+#include <stddef.h>
+
+/*
+ * Whole content of a source file, followed by two NUL bytes
+ * so that flex can scan it in place with yy_scan_buffer().
+ * The file is mapped into memory when possible, otherwise it's read into a heap buffer.
+ * Token nodes keep pointers into this buffer, so it must outlive the syntax tree.
+ */
+class SourceBuffer
+{
+private:
+    char *data;
+    size_t size;        // size of the source, not including the two NUL bytes
+    size_t mappedSize;  // 0 if data is a heap buffer
+    
+    bool mapFile(int fd);
+    bool readFile(int fd);
+public:
+    SourceBuffer();
+    ~SourceBuffer();
+    bool open(const char *path);
+    char* allocate(size_t size);
+    void close();
+    char* getData(){ return this->data;}
+    size_t getSize(){ return this->size;}
+    // size to be passed to yy_scan_buffer()
+    size_t getScanSize(){ return this->size + 2;}
+};
+
+#endif
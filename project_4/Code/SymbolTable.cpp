@@ -2,82 +2,172 @@
 
 SymbolTable::SymbolTable()
 {
-    for(int i = 0; i < MAX_HASH_SIZE; i ++)
-    {
-        hashTable[i] = NULL;
-    }
+    slotBits = MIN_SLOT_BITS;
+    slots.assign(1 << slotBits, EMPTY_TABLE_SLOT);
+    usedSlotNum = 0;
+    itemChunkIndex = -1;
+    itemChunkUsed = ITEM_CHUNK_SIZE;
+    interner = NULL;
+    functionNo = 0;
 
     scopeDepth = 0;
     scopeStack.push(COMMON);
     supportNestedScope = true;
 }
 
-void deleteType(Type type)
-{
-    //TODO:delete type
-}
-void deleteItem(TableItem *item)
-{
-    //TODO:delete item
-}
 SymbolTable::~SymbolTable()
 {
     //free spaces in heap
     clearTable();
+    for(int i = 0; i < (int)itemChunks.size(); i ++)
+    {
+        delete[] itemChunks[i];
+    }
 }
 
 void SymbolTable::setSupportNestedScope(bool support)
 {
     this->supportNestedScope = support;
 }
+
+void SymbolTable::setInterner(Interner *interner)
+{
+    this->interner = interner;
+}
+
+/*
+ * Empty the table so that it can be used for another program.
+ * The slots and item chunks are kept for it.
+ */
 void SymbolTable::clearTable()
 {
-    //clear table
-    for(int i = 0; i < MAX_HASH_SIZE; i ++)
+    slots.assign(slots.size(), EMPTY_TABLE_SLOT);
+    usedSlotNum = 0;
+    itemChunkIndex = -1;
+    itemChunkUsed = ITEM_CHUNK_SIZE;
+    typeContext.clear();
+    functionNo = 0;
+    funDecRecords.clear();
+    scopeLog.clear();
+    scopeLogMarks.clear();
+    scopeDepth = 0;
+    while(!scopeStack.empty())
     {
-        TableItem *p = hashTable[i];
-        while(p)
+        scopeStack.pop();
+    }
+    scopeStack.push(COMMON);
+}
+
+/*
+ * Fibonacci hashing, the top bits of symbol * 2^32 / phi.
+ * Consecutive symbols end up far apart, so runs of probed slots stay short.
+ */
+unsigned int SymbolTable::hash(Symbol symbol)
+{
+    return (symbol * 2654435769u) >> (32 - slotBits);
+}
+
+/*
+ * Return NULL if the symbol has never been added.
+ */
+TableSlot* SymbolTable::findSlot(Symbol symbol)
+{
+    unsigned int mask = slots.size() - 1;
+    for(unsigned int i = hash(symbol); ; i = (i + 1) & mask)
+    {
+        TableSlot *slot = &slots[i];
+        if(slot->symbol == symbol)
         {
-            TableItem *tmp = p;
-            p = p->next;
-            deleteItem(p);
+            return slot;
         }
+        if(slot->symbol == EMPTY_SLOT)
+        {
+            return NULL;
+        }
+    }
+}
+
+TableSlot* SymbolTable::findOrAddSlot(Symbol symbol)
+{
+    if((usedSlotNum + 1) * 2 > (int)slots.size())
+    {
+        resize(slotBits + 1);
+    }
+    unsigned int mask = slots.size() - 1;
+    unsigned int i = hash(symbol);
+    while(slots[i].symbol != symbol && slots[i].symbol != EMPTY_SLOT)
+    {
+        i = (i + 1) & mask;
     }
+    if(slots[i].symbol == EMPTY_SLOT)
+    {
+        slots[i].symbol = symbol;
+        usedSlotNum ++;
+    }
+    return &slots[i];
 }
 
-unsigned int hashPJW(const char *name)
+void SymbolTable::resize(int bits)
 {
-	unsigned int val=0, i;
-	for(; *name; ++name){
-		val = (val<<2)+*name;
-		if(i= val& ~0x3fff)
-			val = (val^(i>>12))&0x3fff;
-	}
-	return val;
+    vector<TableSlot> oldSlots;
+    oldSlots.swap(slots);
+    slotBits = bits;
+    slots.assign(1 << slotBits, EMPTY_TABLE_SLOT);
+    unsigned int mask = slots.size() - 1;
+    for(int i = 0; i < (int)oldSlots.size(); i ++)
+    {
+        if(oldSlots[i].symbol == EMPTY_SLOT)
+        {
+            continue;
+        }
+        unsigned int j = hash(oldSlots[i].symbol);
+        while(slots[j].symbol != EMPTY_SLOT)
+        {
+            j = (j + 1) & mask;
+        }
+        slots[j] = oldSlots[i];
+    }
 }
-unsigned int SymbolTable::hash(const char *name) 
+
+TableItem* SymbolTable::newItem(Symbol symbol, const string& name, Type type, bool isPointer)
 {
-    return hashPJW(name);
+    if(itemChunkUsed == ITEM_CHUNK_SIZE)
+    {
+        itemChunkIndex ++;
+        if(itemChunkIndex == (int)itemChunks.size())
+        {
+            itemChunks.push_back(new TableItem[ITEM_CHUNK_SIZE]);
+        }
+        itemChunkUsed = 0;
+    }
+    TableItem *item = itemChunks[itemChunkIndex] + (itemChunkUsed ++);
+    item->name = name;
+    item->symbol = symbol;
+    item->type = type;
+    item->next = NULL;
+    item->depth = 0;
+    item->isPointer = isPointer;
+    return item;
 }
 
 /*
- * Add an item to the head of the list.
+ * Add an item in front of the items of the same symbol.
  * Set item->scope to current depth of table.
  */
 void SymbolTable::addItem(TableItem *item)
 {
+    TableSlot *slot = findOrAddSlot(item->symbol);
     if(item->type->kind == FUNCTION)
     {
         // nested function not supported
         // all functions will be added to the outmost scope.
         item->depth = 0;
-        int hashValue = hash(item->name.c_str());
-        TableItem *p = hashTable[hashValue];
+        TableItem *p = slot->item;
         // add this new function item to the tail
         if(p == NULL)
         {
             item->next = NULL;
-            hashTable[hashValue] = item;
+            slot->item = item;
         }
         else
         {
@@ -90,106 +180,109 @@ void SymbolTable::addItem(TableItem *item)
     }
     else
     {
+        if(getScopeType() != STRUCT)
+        {
+            renameVariable(slot, item);
+        }
         item->depth = this->scopeDepth;
-        int hashValue = hash(item->name.c_str());
-        item->next = hashTable[hashValue];
-        hashTable[hashValue] = item;
+        item->next = slot->item;
+        slot->item = item;
+        if(this->scopeDepth > 0)
+        {
+            scopeLog.push_back(item);
+        }
     }
 }
 
-void SymbolTable::addFieldList(FieldList fieldList)
+/*
+ * With nested scopes, a function may have many variables of the same name, shadowed or in sibling scopes.
+ * Inter codes name variables by their names, so all but the first of them are renamed to name_n,
+ * skipping the names that appear in the program.
+ */
+void SymbolTable::renameVariable(TableSlot *slot, TableItem *item)
 {
-    TableItem *item = new TableItem();
-    item->name = fieldList->name;
-    item->type = fieldList->type;
-    item->next = NULL;
-    item->isPointer = false;
-    this->addItem(item);
+    if(slot->functionNo != this->functionNo)
+    {
+        slot->functionNo = this->functionNo;
+        slot->suffixNo = -1;
+    }
+    if(slot->suffixNo < 0)
+    {
+        // the first one keeps its name
+        slot->suffixNo = 0;
+        return;
+    }
+    string name;
+    do
+    {
+        slot->suffixNo ++;
+        name = item->name + "_" + to_string(slot->suffixNo);
+    }while(interner != NULL && interner->contains(name));
+    item->name = name;
 }
 
-void SymbolTable::addFieldList(FieldList fieldList, bool isPointer)
+TableItem* SymbolTable::addFieldList(FieldList fieldList)
 {
-    TableItem *item = new TableItem();
-    item->name = fieldList->name;
-    item->type = fieldList->type;
-    item->next = NULL;
-    item->isPointer = isPointer;
+    return addFieldList(fieldList, false);
+}
+
+TableItem* SymbolTable::addFieldList(FieldList fieldList, bool isPointer)
+{
+    TableItem *item = newItem(fieldList->symbol, fieldList->name, fieldList->type, isPointer);
     this->addItem(item);
+    return item;
 }
 
 /*
  * Add a structure to the table.
  * Note: This func adds the definition of some struct. To add an var with struct type, use addFieldList instead.
- * Return a Type so there's no need to new a type elsewhere, 
- *  to make sure there's no Type_ or Structure_ that doesn't keep a pointer in this table.
+ * Return the Type of the structure, which is created here by the table's TypeContext.
  */
 Type SymbolTable::addStructureAndGetType(Structure structure)
 {
-    TableItem *item = new TableItem();
-    item->name = structure->name;
-    item->type = new Type_();
-    item->type->kind = STRUCTURE;
-    item->type->u.structure = structure;
-    item->type->assignType = LEFT;
-    item->next = NULL;
-    item->isPointer = false;
-    this->addItem(item);
-    return item->type;
+    Type type = typeContext.getStructureType(structure);
+    this->addItem(newItem(structure->symbol, structure->name, type, false));
+    return type;
 }
 
 /*
  * Similar to the above.
- */ 
+ */
 Type SymbolTable::addFunctionAndGetType(Function function)
 {
-    TableItem *item = new TableItem();
-    item->name = function->name;
-    item->type = new Type_();
-    item->type->kind = FUNCTION;
-    item->type->u.function = function;
-    item->type->assignType = RIGHT;
-    item->next = NULL;
-    item->isPointer = false;
-    this->addItem(item);
-    return item->type;
+    Type type = typeContext.getFunctionType(function);
+    this->addItem(newItem(function->symbol, function->name, type, false));
+    return type;
 }
 
 
-TableItem* SymbolTable::getItemByName(string name)
+TableItem* SymbolTable::getItemBySymbol(Symbol symbol)
 {
-    int hashValue = hash(name.c_str());
-    TableItem* p = hashTable[hashValue];
-    while(p)
-    {
-        if(p->name.compare(name) == 0)
-        {
-            break;
-        }
-    }
-    return p;
+    TableSlot *slot = findSlot(symbol);
+    return slot == NULL ? NULL : slot->item;
 }
 
 /*
  * Check if an item with the same name exist in the whole table.
  */
-bool SymbolTable::isDuplicatedName(string name)
+bool SymbolTable::isDuplicatedName(Symbol symbol)
 {
-    return getItemByName(name) != NULL;
+    return getItemBySymbol(symbol) != NULL;
 }
 /*
  * Check if an item with the same name exist in table.
  * Return true if an item in current scope is found.
  * As nesting function definition is not supported, this methond should not be called when checking for a function name.
  */
-bool SymbolTable::isDuplicatedNameInCurrentScope(string name)
+bool SymbolTable::isDuplicatedNameInCurrentScope(Symbol symbol)
 {
-    TableItem* item = getItemByName(name);
+    TableItem* item = getItemBySymbol(symbol);
     return item != NULL && item->depth == this->scopeDepth;
 }
 
 /*
  * Change current depth of table.
- * Delete expired items when exit scope.
+ * Unlink the items declared in the scope when exit it, in reverse order.
  * Function definition and declaration is not affected by scope.
  */
 void SymbolTable::enterScope()
@@ -199,8 +292,13 @@ void SymbolTable::enterScope()
         return;
     }
     // cout << "enter scope" << endl;
+    if(this->scopeDepth == 0)
+    {
+        this->functionNo ++;
+    }
     this->scopeDepth ++;
     scopeStack.push(COMMON);
+    scopeLogMarks.push_back(scopeLog.size());
 }
 void SymbolTable::enterScope(ScopeType scopeType)
 {
@@ -211,6 +309,7 @@ void SymbolTable::enterScope(ScopeType scopeType)
     // cout << "enter scope 2" << endl;
     this->scopeDepth ++;
     scopeStack.push(scopeType);
+    scopeLogMarks.push_back(scopeLog.size());
 }
 ScopeType SymbolTable::getScopeType()
 {
@@ -228,21 +327,14 @@ void SymbolTable::exitScope()
     {
         return;
     }
-    for(int i = 0; i < MAX_HASH_SIZE; i ++)
+    int mark = scopeLogMarks.back();
+    scopeLogMarks.pop_back();
+    while((int)scopeLog.size() > mark)
     {
-        // delete items with depth of current scope
-        TableItem *t = hashTable[i];
-        while(t)
-        {
-            if(t->depth < this->scopeDepth)
-            {
-                break;
-            }
-            TableItem *tmp = t;
-            t = t->next;
-            delete tmp;
-        }
-        hashTable[i] = t;
+        // each item is the innermost one of its symbol when it's popped
+        TableItem *item = scopeLog.back();
+        scopeLog.pop_back();
+        findSlot(item->symbol)->item = item->next;
     }
     this->scopeDepth --;
     scopeStack.pop();
@@ -250,9 +342,9 @@ void SymbolTable::exitScope()
 
 bool SymbolTable::functionAllDefined()
 {
-   for(int i = 0; i < MAX_HASH_SIZE; i ++)
+    for(int i = 0; i < (int)slots.size(); i ++)
     {
-        TableItem *t = hashTable[i];
+        TableItem *t = slots[i].item;
         while(t)
         {
             if(t->type->kind == FUNCTION && !t->type->u.function->isDefined)
@@ -261,6 +353,6 @@ bool SymbolTable::functionAllDefined()
             }
             t = t->next;
         }
-    } 
+    }
     return true;
-}
\ No newline at end of file
+}
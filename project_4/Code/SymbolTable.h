@@ -2,69 +2,14 @@
 #define _SYMBOLTABLE_H
 
 #include "common.h"
+#include "Interner.h"
+#include "TypeContext.h"
 #include <stack>
 #include <list>
+#include <vector>
 
-/*
- * Define of Type
- */ 
-typedef struct Type_* Type;
-typedef struct FieldList_* FieldList;
-typedef struct Structure_* Structure;
-typedef struct Function_* Function;
-
-enum BasicType          { INT, FLOAT };
-enum TypeKind           { BASIC, ARRAY, STRUCTURE, FUNCTION, ERROR };
-enum TypeCompare        { MATCH, NOT_SET, NOT_MATCH, LEFT_SMALLER, RIGHT_SMALLER };
-enum AssignType         { LEFT, RIGHT };
 enum ScopeType          { COMMON, STRUCT };
 
-struct Type_
-{
-    TypeKind kind;
-    union
-    {
-        BasicType basic;
-        struct 
-        {
-            Type elem;
-            int size;
-        }array;
-        Structure structure;
-        Function function;
-    }u;
-    /* 
-     * Indicate left value or right value.
-     * Left value can appear on both side of '='
-     * Temporarily, only useful when parsing productions of EXP.
-     * Set RIGHT for FunDec.
-     * Set defaultly to LEFT elsewhere.
-     */
-    AssignType assignType;
-};
-
-struct FieldList_
-{
-    string name;
-    Type type;
-    FieldList tail;
-};
-
-struct Structure_
-{
-    string name;
-    FieldList structureFieldList;
-};
-
-struct Function_
-{
-    string name;
-    // int paramNum;
-    bool isDefined;
-    Type returnType;
-    FieldList params;
-};
-
 // record a declaration of a function
 struct FunDecRecord
 {
@@ -77,9 +22,14 @@ struct FunDecRecord
  */
 struct TableItem
 {
+    /*
+     * Only for printing, items are looked up by symbol.
+     * Variables of a function have different names, see SymbolTable::renameVariable().
+     */
     string name;
+    Symbol symbol;
     Type type;
-    TableItem *next;
+    TableItem *next;    // item of the same symbol in an outer scope, or a function added later
     int depth;      // depth of nesting scope
     /*
      * Pointer type actually not supported, use this field just to make array/struct params work properly.
@@ -89,16 +39,60 @@ struct TableItem
     bool isPointer; 
 };
 
-#define MAX_HASH_SIZE 16384
+/*
+ * A slot of the open addressing table, one for each symbol ever added.
+ * Slots are never removed until clearTable(), so probing needs no tombstones.
+ */
+struct TableSlot
+{
+    Symbol symbol;
+    TableItem *item;    // innermost item of the symbol, NULL if all of them have gone out of scope
+    int functionNo;     // function in which a variable of the symbol was last declared
+    int suffixNo;       // last suffix given to a variable of the symbol in that function, -1 for none
+};
+
+#define EMPTY_SLOT ((Symbol)-1)
+// a slot no symbol has been added to, no variable has been declared in any function
+const TableSlot EMPTY_TABLE_SLOT = { EMPTY_SLOT, NULL, -1, -1 };
+#define MIN_SLOT_BITS 6
+#define ITEM_CHUNK_SIZE 256
 class SymbolTable
 {
 private:
-    TableItem *hashTable[MAX_HASH_SIZE];
+    /*
+     * Slots are probed linearly, their number is a power of 2 and kept at least twice the number of used ones.
+     */
+    vector<TableSlot> slots;
+    int slotBits;
+    int usedSlotNum;
+    /*
+     * Items are allocated in chunks and only freed by clearTable(),
+     * so inter codes can keep pointers to items whose scope has been exited.
+     */
+    vector<TableItem*> itemChunks;
+    int itemChunkIndex;
+    int itemChunkUsed;
+    TypeContext typeContext;
+    Interner *interner;     // names of the program, so renamed variables don't take one of them
+    int functionNo;         // number of functions entered so far
     bool supportNestedScope;
     int scopeDepth;
     stack<ScopeType> scopeStack;
+    /*
+     * Undo log of the nested scopes, items declared in them in order.
+     * scopeLogMarks holds the size of the log when each of the scopes was entered,
+     * so exiting a scope only touches the names it declared.
+     */
+    vector<TableItem*> scopeLog;
+    vector<int> scopeLogMarks;
     
-    unsigned int hash(const char* name);
+    unsigned int hash(Symbol symbol);
+    TableSlot* findSlot(Symbol symbol);
+    TableSlot* findOrAddSlot(Symbol symbol);
+    void resize(int bits);
+    TableItem* newItem(Symbol symbol, const string& name, Type type, bool isPointer);
+    void addItem(TableItem *item);
+    void renameVariable(TableSlot *slot, TableItem *item);
     
 public:
     list<FunDecRecord> funDecRecords;
@@ -106,15 +100,16 @@ public:
     SymbolTable();
     ~SymbolTable();
     void setSupportNestedScope(bool support);
+    void setInterner(Interner *interner);
+    TypeContext* getTypeContext(){ return &this->typeContext;}
     void clearTable();
-    void addItem(TableItem *item);
-    void addFieldList(FieldList fieldList);
-    void addFieldList(FieldList fieldList, bool isPointer);
+    TableItem* addFieldList(FieldList fieldList);
+    TableItem* addFieldList(FieldList fieldList, bool isPointer);
     Type addStructureAndGetType(Structure structure);
     Type addFunctionAndGetType(Function function);
-    TableItem* getItemByName(string name);
-    bool isDuplicatedName(string name);
-    bool isDuplicatedNameInCurrentScope(string name);
+    TableItem* getItemBySymbol(Symbol symbol);
+    bool isDuplicatedName(Symbol symbol);
+    bool isDuplicatedNameInCurrentScope(Symbol symbol);
 
     void enterScope();
     void enterScope(ScopeType scopeType);
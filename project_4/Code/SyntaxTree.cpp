@@ -1,26 +1,49 @@
 #include "SyntaxTree.h"
 
+const char* const nodeKindNames[(int)NodeKind::NODE_KIND_NUM] =
+{
+#define NODE_KIND_NAME(name) #name,
+    NODE_KIND_LIST(NODE_KIND_NAME)
+#undef NODE_KIND_NAME
+};
+
 /*
- * Constructor.
- * @param value
- *  For non-terminals, set to "", because the value field is meaningless.
- *  For a termianl symbol, value is the actual text of it.
+ * Constructor of non-terminals.
  */
-Node::Node(NodeType nodeType, string nodeName, int lineno)
+Node::Node(NodeType nodeType, NodeKind kind, int lineno)
 {
     this->nodeType = nodeType;
-    this->nodeName = nodeName;
+    this->kind = kind;
     this->lineno = lineno;
-    this->value = ""; // set default value;
+    this->text = NULL;
+    this->textLength = 0;
+    this->symbol = SYMBOL_EMPTY;
+    this->item = NULL;
+    this->type = NULL;
+    this->productionNo = 0;
+    this->children = NULL;
+    this->childNum = 0;
     this->father = NULL;
 }
 
-Node::Node(NodeType nodeType, string nodeName, string value, int lineno)
+/*
+ * Constructor of terminals.
+ * @param text
+ *  The actual text of it, only the pointer is kept, so it should stay valid as long as the node.
+ */
+Node::Node(NodeType nodeType, NodeKind kind, const char *text, int textLength, int lineno)
 {
     this->nodeType = nodeType;
-    this->nodeName = nodeName;
+    this->kind = kind;
     this->lineno = lineno;
-    this->value = value;
+    this->text = text;
+    this->textLength = textLength;
+    this->symbol = SYMBOL_EMPTY;
+    this->item = NULL;
+    this->type = NULL;
+    this->productionNo = 0;
+    this->children = NULL;
+    this->childNum = 0;
     this->father = NULL;
 }
 
@@ -32,133 +55,116 @@ Node::~Node()
 {
 
 }
-void Node::setValue(int value)
-{
-    this->value = to_string(value);
-}
-void Node::setValue(float value)
-{
-    this->value = to_string(value);
-}
-void Node::setValue(string value)
-{
-    this->value = value;
-}
+
+/*
+ * Value of an integer constant.
+ * Parse the text directly, digits are taken until the first character that's not valid in the base,
+ * so an illegal constant like "09a" still gets a value.
+ */
 int Node::getIntValue()
 {
-    int int_value = 0;
-    stringstream ss;
+    int base;
+    int i = 0;
     switch(this->nodeType)
     {
         case NODE_TYPE_DEC_INT:
-            ss << this->value;
-            ss >> int_value;
+            base = 10;
             break;
         case NODE_TYPE_OCT_INT:
-            ss << std::oct << this->value;
-            ss >> std::oct >> int_value;
+            base = 8;
+            i = 1;  // skip "0"
             break;
         case NODE_TYPE_HEX_INT:
-            ss << std::hex << this->value;
-            ss >> std::hex >> int_value;
+            base = 16;
+            i = 2;  // skip "0x"
             break;
-        default: ;
+        default:
+            return 0;
     }
-    return int_value;
-    // return atoi(this->value.c_str());
+    unsigned int int_value = 0;
+    for(; i < this->textLength; i ++)
+    {
+        char c = this->text[i];
+        int digit;
+        if(c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if(c >= 'a' && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else if(c >= 'A' && c <= 'F')
+        {
+            digit = c - 'A' + 10;
+        }
+        else
+        {
+            break;
+        }
+        if(digit >= base)
+        {
+            break;
+        }
+        int_value = int_value * base + digit;
+    }
+    return (int)int_value;
 }
 float Node::getFloatValue()
 {
-    return atof(this->value.c_str());
-}
-string Node::getValue()
-{
-    return this->value;
+    return atof(getValue().c_str());
 }
 
 /*
- * Get actual text of a node.
- * For non-terminal, traverse all its sub trees and join all the strings of terminals.
+ * Copy the text of a terminal.
+ * Return "" for non-terminals.
  */
-string Node::getText()
+string Node::getValue()
 {
-    string s = this->value;
-    for (vector<Node*>::iterator it = this->children.begin(); it != this->children.end(); it ++)
+    if(this->text == NULL)
     {
-        s += (*it)->getText();
+        return "";
     }
-    return s;
+    return string(this->text, this->textLength);
 }
 
 /*
- * Add a child to this node, and let the child node's father point to this node
- * Note: 
- *  If a NULL node is added as child, this should only be the case where an empty string is detected in some grammar rule.
- *  As it is useless in syntax tree(at least for now), just return; 
+ * Get actual text of a node.
+ * For non-terminal, traverse all its sub trees and join all the strings of terminals.
  */
-void Node::addChild(Node *node)
+string Node::getText()
 {
-    
-    this->children.push_back(node);
-    if(node != NULL)
+    string s = getValue();
+    for (int i = 0; i < this->childNum; i ++)
     {
-        node->setFather(this);
+        if(this->children[i] != NULL)
+        {
+            s += this->children[i]->getText();
+        }
     }
+    return s;
 }
 
 /*
  * Let the father of this node point to a certain node.
- * As a node's father would only be set when it's added to some node's children list
- * this function should be private, and only be called in addChild()  
+ * As a node's father would only be set when it's created as some node's child
+ * this function should be private, and only be called in NodePool::newNode()
  */
 void Node::setFather(Node *node)
 {
-    node->father = node;
+    this->father = node;
 }
 Node* Node::getFather()
 {
     return this->father;
 }
 
-Node* Node::getChild(int index)
-{
-    // cout << this->nodeName << index << "," << this->children.size() << endl;
-    try
-    {
-        return this->children.at(index);
-    }
-    catch(exception& e)
-    {
-        return NULL;
-    }
-}
-
-/**
- * Delete the whole sub tree
- * which means delete/free this node, along with all its descendants
- */
-void Node::deleteTree(Node*root)
-{
-    if(root == NULL) 
-    {
-        return;
-    }
-
-    for (vector<Node*>::iterator it = root->children.begin(); it != root->children.end();)
-    {
-        Node *p = *it;
-        it ++;
-        deleteTree(p);
-    }
-    delete root;
-}
-
 /*
  * Print node info for debugging.
  */
 void Node::printNode()
 {
-    printf("%s (%d)\n", this->nodeName.c_str(), this->lineno);
+    printf("%s (%d)\n", getNodeName(), this->lineno);
 }
 /**
  * Traverse the sub tree and print it, only for project_1 requirements.
@@ -176,53 +182,38 @@ void Node::printTree(Node*p, int depth)
     {
         printf("  ");   // two space
     }
-    // printf("%s (%d)\n", p->nodeName.c_str(), p->lineno);
-    stringstream ss;
-    int int_value;
-    float float_value;
+    // printf("%s (%d)\n", p->getNodeName(), p->lineno);
     switch(p->nodeType)
     {
         case NODE_TYPE_NON_TERMINAL:
         case NODE_TYPE_RELOP:
-            printf("%s (%d)\n", p->nodeName.c_str(), p->lineno);
+            printf("%s (%d)\n", p->getNodeName(), p->lineno);
             break;
         case NODE_TYPE_DEC_INT:
-            ss << p->value;
-            ss >> int_value;
-            printf("%s: %d\n", p->nodeName.c_str(), int_value);
-            break;
         case NODE_TYPE_OCT_INT:
-            ss << std::oct << p->value;
-            ss >> std::oct >> int_value;
-            printf("%s: %d\n", p->nodeName.c_str(), int_value);
-            break;
         case NODE_TYPE_HEX_INT:
-            ss << std::hex << p->value;
-            ss >> std::hex >> int_value;
-            printf("%s: %d\n", p->nodeName.c_str(), int_value);
+            printf("%s: %d\n", p->getNodeName(), p->getIntValue());
             break;
         case NODE_TYPE_FLOAT:
-            ss << p->value;
-            ss >> float_value;
-            printf("%s: %f\n", p->nodeName.c_str(), float_value);
+            printf("%s: %f\n", p->getNodeName(), p->getFloatValue());
             break;
         case NODE_TYPE_ID:
         case NODE_TYPE_KEYWORD:
-            printf("%s: %s\n", p->nodeName.c_str(), p->value.c_str());
+            printf("%s: %.*s\n", p->getNodeName(), p->textLength, p->text);
             break;
         case NODE_TYPE_BRACKET:
         case NODE_TYPE_PUNCTUATION:
         case NODE_TYPE_OPERATOR:
-            printf("%s\n", p->nodeName.c_str());
+            printf("%s\n", p->getNodeName());
             break;
         default:
-            printf("%s (%d)\n", p->nodeName.c_str(), p->lineno);
+            printf("%s (%d)\n", p->getNodeName(), p->lineno);
             break;
     }
 
-    for (vector<Node*>::iterator it = p->children.begin(); it != p->children.end(); it ++)
+    for (int i = 0; i < p->childNum; i ++)
     {
-        printTree(*it, depth + 1);
+        printTree(p->children[i], depth + 1);
     }
 }
 
@@ -233,5 +224,150 @@ void Node::printTree(Node*root)
 {
     printTree(root, 0);
 }
-    
 
+NodePool::NodePool()
+{
+    nodeChunkIndex = -1;
+    nodeChunkUsed = NODE_CHUNK_SIZE;
+    slotChunkIndex = -1;
+    slotChunkUsed = CHILD_SLOT_CHUNK_SIZE;
+}
+
+NodePool::~NodePool()
+{
+    clear();
+}
+
+Node* NodePool::allocNode()
+{
+    if(nodeChunkUsed == NODE_CHUNK_SIZE)
+    {
+        nodeChunkIndex ++;
+        if(nodeChunkIndex == (int)nodeChunks.size())
+        {
+            nodeChunks.push_back((Node*)::operator new(sizeof(Node) * NODE_CHUNK_SIZE));
+        }
+        nodeChunkUsed = 0;
+    }
+    return nodeChunks[nodeChunkIndex] + (nodeChunkUsed ++);
+}
+
+/*
+ * Reserve 'num' contiguous child slots.
+ * The tail of a chunk is simply skipped if it can't hold all of them.
+ */
+Node** NodePool::allocSlots(int num)
+{
+    if(slotChunkUsed + num > CHILD_SLOT_CHUNK_SIZE)
+    {
+        slotChunkIndex ++;
+        if(slotChunkIndex == (int)slotChunks.size())
+        {
+            slotChunks.push_back(new Node*[CHILD_SLOT_CHUNK_SIZE]);
+        }
+        slotChunkUsed = 0;
+    }
+    Node **slots = slotChunks[slotChunkIndex] + slotChunkUsed;
+    slotChunkUsed += num;
+    return slots;
+}
+
+Node* NodePool::newNode(NodeType nodeType, NodeKind kind, const char *text, int textLength, int lineno)
+{
+    return new (allocNode()) Node(nodeType, kind, text, textLength, lineno);
+}
+
+/*
+ * Create a non-terminal node.
+ * @param children
+ *  Right side of the production, in order. NULL stands for an empty sub tree.
+ */
+Node* NodePool::newNode(NodeKind kind, int lineno, int productionNo, initializer_list<Node*> children)
+{
+    Node *node = new (allocNode()) Node(NODE_TYPE_NON_TERMINAL, kind, lineno);
+    node->productionNo = productionNo;
+    node->childNum = children.size();
+    node->children = allocSlots(node->childNum);
+    int i = 0;
+    for(initializer_list<Node*>::iterator it = children.begin(); it != children.end(); it ++)
+    {
+        node->children[i ++] = *it;
+        if(*it != NULL)
+        {
+            (*it)->setFather(node);
+        }
+    }
+    return node;
+}
+
+NodePoolMark NodePool::mark()
+{
+    NodePoolMark m;
+    m.nodeChunkIndex = nodeChunkIndex;
+    m.nodeChunkUsed = nodeChunkUsed;
+    m.slotChunkIndex = slotChunkIndex;
+    m.slotChunkUsed = slotChunkUsed;
+    return m;
+}
+
+/**
+ * Destroy all the nodes created after 'mark', their memory is reused by nodes created later.
+ * Nodes are destroyed chunk by chunk, there's no need to traverse the tree.
+ * @param keep
+ *  NULL, or a terminal created after 'mark' that should survive, e.g. the parser's lookahead token.
+ *  It's moved to right after 'mark', and *keep is updated.
+ */
+void NodePool::release(NodePoolMark mark, Node **keep)
+{
+    if(keep != NULL && *keep != NULL)
+    {
+        Node saved = **keep;
+        release(mark, NULL);
+        *keep = new (allocNode()) Node(saved);
+        return;
+    }
+    for(int i = (mark.nodeChunkIndex < 0 ? 0 : mark.nodeChunkIndex); i <= nodeChunkIndex; i ++)
+    {
+        int begin = (i == mark.nodeChunkIndex) ? mark.nodeChunkUsed : 0;
+        int end = (i == nodeChunkIndex) ? nodeChunkUsed : NODE_CHUNK_SIZE;
+        for(int j = begin; j < end; j ++)
+        {
+            nodeChunks[i][j].~Node();
+        }
+    }
+    nodeChunkIndex = mark.nodeChunkIndex;
+    nodeChunkUsed = mark.nodeChunkUsed;
+    slotChunkIndex = mark.slotChunkIndex;
+    slotChunkUsed = mark.slotChunkUsed;
+}
+
+/**
+ * Destroy all the nodes at once, but keep the chunks to build the next tree in.
+ */
+void NodePool::reset()
+{
+    NodePoolMark start;
+    start.nodeChunkIndex = -1;
+    start.nodeChunkUsed = NODE_CHUNK_SIZE;
+    start.slotChunkIndex = -1;
+    start.slotChunkUsed = CHILD_SLOT_CHUNK_SIZE;
+    release(start, NULL);
+}
+
+/**
+ * Free all the nodes, and the memory they take up.
+ */
+void NodePool::clear()
+{
+    reset();
+    for(int i = 0; i < (int)nodeChunks.size(); i ++)
+    {
+        ::operator delete(nodeChunks[i]);
+    }
+    for(int i = 0; i < (int)slotChunks.size(); i ++)
+    {
+        delete[] slotChunks[i];
+    }
+    nodeChunks.clear();
+    slotChunks.clear();
+}
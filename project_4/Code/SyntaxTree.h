@@ -2,14 +2,15 @@
 #define _SYNTAXTREE_H
 
 #include "common.h"
+#include "NodeKind.h"
+#include "Interner.h"
 #include <list>
 #include <vector>
 #include <sstream>
-#include <exception>
+#include <initializer_list>
+#include <new>
 
-extern int yylineno;
-
-enum NodeType
+enum NodeType : unsigned char
 {
     /*
      * Imply type of a node in syntax tree
@@ -21,44 +22,121 @@ enum NodeType
     NODE_TYPE_NON_TERMINAL
 };
 
-class Node 
+class NodePool;
+// not included, the tokens of syntax.y would clash with the enums of TypeContext.h
+struct TableItem;
+typedef struct Type_* Type;
+
+class Node
 {
 private:
+    friend class NodePool;
 
+    NodeKind kind;
     NodeType nodeType;
-    string nodeName;
-    string value;   //attribute value
+    short productionNo;   //start from 0
     int lineno;
-    int productionNo;   //start from 0
+    /*
+     * Text of a terminal, a view into the source buffer (see SourceBuffer.h), not NUL terminated.
+     * NULL for non-terminals.
+     */
+    const char *text;
+    int textLength;
+    Symbol symbol;      // interned text of an ID, SYMBOL_EMPTY for other nodes
+    /*
+     * Filled in by the semantic analyzer, so that later passes don't look names up again.
+     * item: what an ID refers to, or declares in a VarDec, NULL if it's undefined or redefined there
+     * type: type of an Exp
+     */
+    TableItem *item;
+    Type type;
 
-    vector<Node*> children;
+    /*
+     * Children are a contiguous range of child slots owned by the NodePool,
+     * filled in once when the node is created.
+     */
+    Node **children;
+    int childNum;
     Node *father;
 
     void setFather(Node *node);
     void printNode();
 public:
 
-    Node(NodeType nodeType, string nodeName, int lineno);
-    Node(NodeType nodeType, string nodeName, string value, int lineno);
+    Node(NodeType nodeType, NodeKind kind, int lineno);
+    Node(NodeType nodeType, NodeKind kind, const char *text, int textLength, int lineno);
     ~Node();
-    void setValue(int value);
-    void setValue(float value);
-    void setValue(string value);
     NodeType getNodeType(){ return this->nodeType;}
-    string getNodeName(){ return this->nodeName;}
+    NodeKind getKind(){ return this->kind;}
+    const char* getNodeName(){ return nodeKindName(this->kind);}
     int getIntValue();
     float getFloatValue();
     string getValue();
+    const char* getTextPtr(){ return this->text;}
+    int getTextLength(){ return this->textLength;}
+    Symbol getSymbol(){ return this->symbol;}
+    void setSymbol(Symbol symbol){ this->symbol = symbol;}
+    TableItem* getItem(){ return this->item;}
+    void setItem(TableItem *item){ this->item = item;}
+    Type getType(){ return this->type;}
+    void setType(Type type){ this->type = type;}
     string getText();
     int getLineno(){ return this->lineno;}
     void setProductionNo(int no){ this->productionNo = no;}
     int getProductionNo(){ return this->productionNo;}
-    void addChild(Node *node);
     Node* getFather();
-    Node* getChild(int index);
-    static void deleteTree(Node *root);
+    int getChildNum(){ return this->childNum;}
+    /*
+     * Bounds-checked child access, never throws.
+     * Return NULL if there's no such child, or the child is an empty sub tree.
+     */
+    Node* getChild(int index)
+    {
+        return (index >= 0 && index < this->childNum) ? this->children[index] : NULL;
+    }
     static void printTree(Node *root, int depth);
     static void printTree(Node *root);
 };
 
-#endif
\ No newline at end of file
+/*
+ * Arena that owns every node of a syntax tree.
+ * Nodes and child slots are bump-allocated from fixed-size chunks,
+ * so building a tree costs a few large allocations and the whole tree is freed at once by clear().
+ * Pointers handed out stay valid until reset() or clear() is called.
+ */
+#define NODE_CHUNK_SIZE 1024
+#define CHILD_SLOT_CHUNK_SIZE 4096
+
+// a point in the allocation of a NodePool, see NodePool::release()
+struct NodePoolMark
+{
+    int nodeChunkIndex, nodeChunkUsed;
+    int slotChunkIndex, slotChunkUsed;
+};
+
+class NodePool
+{
+private:
+    vector<Node*> nodeChunks;
+    int nodeChunkIndex;         // chunk in use, chunks after it are kept by reset() for reuse
+    int nodeChunkUsed;          // nodes used in the chunk in use
+    vector<Node**> slotChunks;
+    int slotChunkIndex;
+    int slotChunkUsed;
+
+    Node* allocNode();
+    Node** allocSlots(int num);
+public:
+    NodePool();
+    ~NodePool();
+    // terminal
+    Node* newNode(NodeType nodeType, NodeKind kind, const char *text, int textLength, int lineno);
+    // non-terminal, with all its children
+    Node* newNode(NodeKind kind, int lineno, int productionNo, initializer_list<Node*> children);
+    NodePoolMark mark();
+    void release(NodePoolMark mark, Node **keep);
+    void reset();
+    void clear();
+};
+
+#endif
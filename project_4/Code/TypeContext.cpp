@@ -0,0 +1,124 @@
+#include "TypeContext.h"
+
+TypeContext::TypeContext()
+{
+    for(int i = 0; i < 2; i ++)
+    {
+        basicTypes[i].kind = BASIC;
+        basicTypes[i].u.basic = (BasicType)i;
+        basicTypes[i].size = 4;
+        basicTypes[i].canonical = &basicTypes[i];
+        basicTypes[i].hasError = false;
+    }
+    errorType.kind = ERROR;
+    errorType.size = 0;
+    errorType.canonical = &errorType;
+    errorType.hasError = true;
+}
+
+Type TypeContext::newType(TypeKind kind, int size)
+{
+    Type type = region.make<Type_>();
+    type->kind = kind;
+    type->size = size;
+    type->canonical = type;
+    type->hasError = false;
+    return type;
+}
+
+/*
+ * Array types of the same element type and size are the same object.
+ */
+Type TypeContext::getArrayType(Type elem, int size)
+{
+    map<pair<Type, int>, Type>::iterator it = arrayTypes.find(make_pair(elem, size));
+    if(it != arrayTypes.end())
+    {
+        return it->second;
+    }
+    Type type = newType(ARRAY, size * elem->size);
+    type->u.array.elem = elem;
+    type->u.array.size = size;
+    type->hasError = elem->hasError;
+    arrayTypes[make_pair(elem, size)] = type;
+    // the first array of a canonical element type represents all of them
+    map<Type, Type>::iterator canonical = canonicalArrays.find(elem->canonical);
+    if(canonical == canonicalArrays.end())
+    {
+        canonicalArrays[elem->canonical] = type;
+    }
+    else
+    {
+        type->canonical = canonical->second;
+    }
+    return type;
+}
+
+/*
+ * Each structure definition has a type of its own, as its fields have their own names,
+ * but structures with matching fields share the canonical type.
+ * The layout of the structure is built here, so the fields should all have their types when it's called.
+ */
+Type TypeContext::getStructureType(Structure structure)
+{
+    StructLayout layout = region.make<StructLayout_>();
+    vector<Type> fieldTypes;
+    bool hasError = false;
+    int offset = 0;
+    for(FieldList field = structure->structureFieldList; field != NULL; field = field->tail)
+    {
+        FieldLayout fieldLayout;
+        fieldLayout.symbol = field->symbol;
+        fieldLayout.type = field->type;
+        fieldLayout.offset = offset;
+        layout->fieldIndexes.insert(make_pair(field->symbol, (int)layout->fields.size()));
+        layout->fields.push_back(fieldLayout);
+        offset += field->type->size;
+        fieldTypes.push_back(field->type->canonical);
+        hasError = hasError || field->type->hasError;
+    }
+    layout->size = offset;
+    structure->layout = layout;
+
+    Type type = newType(STRUCTURE, layout->size);
+    type->u.structure = structure;
+    type->hasError = hasError;
+    map<vector<Type>, Type>::iterator canonical = canonicalStructures.find(fieldTypes);
+    if(canonical == canonicalStructures.end())
+    {
+        canonicalStructures[fieldTypes] = type;
+    }
+    else
+    {
+        type->canonical = canonical->second;
+    }
+    return type;
+}
+
+Type TypeContext::getFunctionType(Function function)
+{
+    Type type = newType(FUNCTION, 0);
+    type->u.function = function;
+    map<Symbol, Type>::iterator canonical = canonicalFunctions.find(function->symbol);
+    if(canonical == canonicalFunctions.end())
+    {
+        canonicalFunctions[function->symbol] = type;
+    }
+    else
+    {
+        type->canonical = canonical->second;
+    }
+    return type;
+}
+
+/*
+ * Free all the types but the basic ones and the error type, so the context can be used for another program.
+ */
+void TypeContext::clear()
+{
+    region.reset();
+    arrayTypes.clear();
+    canonicalArrays.clear();
+    canonicalStructures.clear();
+    canonicalFunctions.clear();
+}
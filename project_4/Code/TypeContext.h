@@ -0,0 +1,140 @@
+#ifndef _TYPECONTEXT_H
+#define _TYPECONTEXT_H
+
+#include "common.h"
+#include "Interner.h"
+#include "Region.h"
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Define of Type
+ */
+typedef struct Type_* Type;
+typedef struct FieldList_* FieldList;
+typedef struct Structure_* Structure;
+typedef struct Function_* Function;
+typedef struct StructLayout_* StructLayout;
+
+enum BasicType          { INT, FLOAT };
+enum TypeKind           { BASIC, ARRAY, STRUCTURE, FUNCTION, ERROR };
+enum TypeCompare        { MATCH, NOT_SET, NOT_MATCH, LEFT_SMALLER, RIGHT_SMALLER };
+/*
+ * Indicate left value or right value.
+ * Left value can appear on both side of '='
+ * Only useful when parsing productions of EXP, see ExpType in SemanticAnalyzer.h.
+ */
+enum AssignType         { LEFT, RIGHT };
+
+/*
+ * Types are only created by a TypeContext, the same type is always the same object.
+ */
+struct Type_
+{
+    TypeKind kind;
+    union
+    {
+        BasicType basic;
+        struct
+        {
+            Type elem;
+            int size;
+        }array;
+        Structure structure;
+        Function function;
+    }u;
+    int size;   // in bytes, 0 for functions and the error type
+    /*
+     * Representative of all the types that match this one, so matching types have the same canonical type:
+     * arrays match if their elements match, whatever the size,
+     * structures match if their fields match one by one, whatever the names,
+     * functions match if they have the same name.
+     */
+    Type canonical;
+    /*
+     * Whether the error type appears in this type, e.g. an array of an undefined struct.
+     * The error type matches anything, so such types are compared field by field.
+     */
+    bool hasError;
+};
+
+struct FieldList_
+{
+    string name;
+    Symbol symbol;
+    Type type;
+    FieldList tail;
+};
+
+struct Structure_
+{
+    string name;
+    Symbol symbol;
+    FieldList structureFieldList;
+    StructLayout layout;    // set when the type of the structure is created
+};
+
+struct FieldLayout
+{
+    Symbol symbol;
+    Type type;
+    int offset;     // from the start of the structure, in bytes
+};
+
+/*
+ * Where the fields of a structure are, worked out once for its type.
+ */
+struct StructLayout_
+{
+    vector<FieldLayout> fields;         // in order of declaration
+    unordered_map<Symbol, int> fieldIndexes;    // symbol -> index in fields, the first one for duplicated names
+    int size;
+
+    FieldLayout* getField(Symbol symbol)
+    {
+        unordered_map<Symbol, int>::iterator it = fieldIndexes.find(symbol);
+        return it == fieldIndexes.end() ? NULL : &fields[it->second];
+    }
+};
+
+struct Function_
+{
+    string name;
+    Symbol symbol;
+    // int paramNum;
+    bool isDefined;
+    Type returnType;
+    FieldList params;
+};
+
+/*
+ * Creates and owns all the types of a program, and the parts of them: fields, structures, functions.
+ * Basic types and the error type live as long as the context, others are in its region until clear().
+ */
+class TypeContext
+{
+private:
+    Type_ basicTypes[2];    // indexed by BasicType
+    Type_ errorType;
+    Region region;
+    map<pair<Type, int>, Type> arrayTypes;          // (element, size) -> array
+    map<Type, Type> canonicalArrays;                // canonical element -> canonical array
+    map<vector<Type>, Type> canonicalStructures;    // canonical field types -> canonical structure
+    map<Symbol, Type> canonicalFunctions;
+
+    Type newType(TypeKind kind, int size);
+public:
+    TypeContext();
+    Type getBasicType(BasicType basic){ return &this->basicTypes[basic];}
+    Type getErrorType(){ return &this->errorType;}
+    Type getArrayType(Type elem, int size);
+    Type getStructureType(Structure structure);
+    Type getFunctionType(Function function);
+    FieldList newFieldList(){ return region.make<FieldList_>();}
+    Structure newStructure(){ return region.make<Structure_>();}
+    Function newFunction(){ return region.make<Function_>();}
+    void clear();
+};
+
+#endif
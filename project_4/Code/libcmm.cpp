@@ -0,0 +1,57 @@
+#include "libcmm.h"
+#include "Compiler.h"
+#include <sstream>
+#include <string.h>
+
+CmmCompiler::CmmCompiler()
+{
+    compiler = new Compiler(NULL);
+}
+
+CmmCompiler::~CmmCompiler()
+{
+    delete compiler;
+}
+
+CmmResult CmmCompiler::compile(const char *source, size_t length)
+{
+    // the scanner needs a writable copy ending with two NULs
+    SourceBuffer sourceBuffer;
+    char *data = sourceBuffer.allocate(length);
+    CmmResult result;
+    if(data == NULL)
+    {
+        result.succeeded = false;
+        result.diagnostics = "out of memory\n";
+        return result;
+    }
+    memcpy(data, source, length);
+
+    ostringstream diagnostics, ir, mips;
+    compiler->setDiagnostics(&diagnostics);
+    result.succeeded = compiler->compile(&sourceBuffer, &ir, &mips);
+    compiler->setDiagnostics(NULL);
+    result.diagnostics = diagnostics.str();
+    if(result.succeeded)
+    {
+        istringstream lines(ir.str());
+        string line;
+        while(getline(lines, line))
+        {
+            result.interCodes.push_back(line);
+        }
+        result.mips = mips.str();
+    }
+    return result;
+}
+
+CmmResult CmmCompiler::compile(const string& source)
+{
+    return compile(source.data(), source.size());
+}
+
+CmmResult cmmCompile(const char *source, size_t length)
+{
+    CmmCompiler compiler;
+    return compiler.compile(source, length);
+}
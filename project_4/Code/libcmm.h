@@ -0,0 +1,52 @@
+#ifndef _LIBCMM_H
+#define _LIBCMM_H
+
+/*
+ * Public interface of libcmm, the C-- compiler as a library.
+ * Compiles a source held in memory, and returns everything in memory:
+ * no file is read or written.
+ *
+ *  CmmCompiler compiler;
+ *  CmmResult result = compiler.compile("int main(){ write(1); return 0; }");
+ *  if(result.succeeded) cout << result.mips;
+ *  else cout << result.diagnostics;
+ */
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+struct CmmResult
+{
+    bool succeeded;
+    std::string diagnostics;            // lexical, syntax and semantic errors, one per line
+    std::vector<std::string> interCodes;// one inter code per element, without line breaks
+    std::string mips;                   // MIPS32 assembly
+};
+
+class Compiler;
+
+/*
+ * A compiler that can be used for any number of sources.
+ * It keeps its state between calls, so reusing one is cheaper than creating one per source.
+ * A CmmCompiler must not be used by two threads at the same time, use one per thread instead.
+ */
+class CmmCompiler
+{
+private:
+    Compiler *compiler;
+    CmmCompiler(const CmmCompiler&);
+    CmmCompiler& operator=(const CmmCompiler&);
+public:
+    CmmCompiler();
+    ~CmmCompiler();
+    CmmResult compile(const char *source, size_t length);
+    CmmResult compile(const std::string& source);
+};
+
+/*
+ * Compile one source with a compiler of its own.
+ */
+CmmResult cmmCompile(const char *source, size_t length);
+
+#endif
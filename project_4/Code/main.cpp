@@ -1,56 +1,108 @@
 #include "common.h"
-#include "parseCommon.h"
-#include "SemanticAnalyzer.h"
-#include "InterCode.h"
-#include "MIPS.h"
+#include "Compiler.h"
+#include "CompileServer.h"
+#include "CompileProtocol.h"
+#include <thread>
+#include <unistd.h>
 
-Node* treeRoot = NULL;
-SyntaxErrorFlag syntaxErrorFlag = NO_SYNTAX_ERROR;
-LexErrorFlag lexErrorFlag = NO_LEX_ERROR;
+/*
+ * Usage:
+ *  parser source [output]
+ *      Compile one file, MIPS32 code goes to output or stdout.
+ *  parser [-j workers] [-d outputDir] [-i] [-g] [-s] [-O] [-m manifest] sources...
+ *      Compile many files on a pool of worker threads, each source gets its own .s file
+ *      (and .ir file with -i). Sources may also be listed in a manifest, one per line.
+ *      With -g, the .ir file shows the control flow graph of each function, see Compiler::setDumpCFG().
+ *      With -s, each file is compiled in streaming mode, see Compiler::setStreaming().
+ *      With -O, the inter codes are optimized, see Compiler::setOptimize().
+ *      Diagnostics are printed in the order of sources, then a summary of throughput and latency.
+ *  parser -S socket [-j workers]
+ *      Run as a compile server on a Unix domain socket ("" for the default one), see CompileServer.h.
+ *      Client/cmmc is a client that can be used in place of parser.
+ */
+static int optionMain(int argc, char** argv)
+{
+    int workerNum = thread::hardware_concurrency();
+    string outputDir = "";
+    string manifest = "";
+    bool emitIR = false;
+    bool dumpCFG = false;
+    bool streaming = false;
+    bool optimize = false;
+    bool serverMode = false;
+    string socketPath = "";
+    int opt;
+    while((opt = getopt(argc, argv, "j:d:igsOm:S:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'S':
+                serverMode = true;
+                socketPath = optarg[0] != '\0' ? optarg : DEFAULT_SOCKET_PATH;
+                break;
+            case 'j':
+                workerNum = atoi(optarg);
+                break;
+            case 'd':
+                outputDir = optarg;
+                break;
+            case 'i':
+                emitIR = true;
+                break;
+            case 'g':
+                emitIR = true;
+                dumpCFG = true;
+                break;
+            case 's':
+                streaming = true;
+                break;
+            case 'O':
+                optimize = true;
+                break;
+            case 'm':
+                manifest = optarg;
+                break;
+            default:
+                return 1;
+        }
+    }
+    if(serverMode)
+    {
+        CompileServer server(socketPath, workerNum);
+        if(!server.start())
+        {
+            perror(socketPath.c_str());
+            return 1;
+        }
+        server.run();
+        return 0;
+    }
 
+    BatchCompiler batchCompiler(workerNum, outputDir, emitIR, streaming, dumpCFG, optimize);
+    if(manifest != "" && !batchCompiler.addManifest(manifest))
+    {
+        perror(manifest.c_str());
+        return 1;
+    }
+    for(int i = optind; i < argc; i ++)
+    {
+        batchCompiler.addSource(argv[i]);
+    }
+    batchCompiler.run();
+    batchCompiler.printDiagnostics(cout);
+    batchCompiler.printSummary(cout);
+    return batchCompiler.allSucceeded() ? 0 : 1;
+}
 
 int main(int argc, char** argv) {
     if(argc <= 1)
     {
         return 1;
     }
-	FILE* f = fopen(argv[1], "r");
-	if(!f)
-	{
-		perror(argv[1]);
-		return 1;
-	}
-	yyrestart(f);
-	yyparse();
-
-	if(lexErrorFlag == NO_LEX_ERROR && syntaxErrorFlag == NO_SYNTAX_ERROR)
-	{
-		#ifdef DEBUG
-			Node::printTree(treeRoot);
-		#endif
-		
-		SemanticAnalyzer semanticAnalyzer;
-		semanticAnalyzer.getSymbolTable()->setSupportNestedScope(false); // nested scope not supported for inter code yet
-		semanticAnalyzer.analyse(treeRoot);
-		if(semanticAnalyzer.getSemanticErrorFlag() == NO_SEMANTIC_ERROR)
-		{
-			InterCodeTranslater IRT(semanticAnalyzer.getSymbolTable());
-			IRT.translate(treeRoot);
-			MIPS32Translater MT;
-			MT.translate(IRT.getInterCodeList());
-			if(argc >= 3)
-			{
-				// IRT.output(argv[2]);
-				MT.output(argv[2]);
-			}
-			else
-			{
-				// IRT.output();
-				MT.output();
-			}
-		}
-	}
-
-	Node::deleteTree(treeRoot);
-	return 0;
-}
\ No newline at end of file
+    if(argv[1][0] == '-')
+    {
+        return optionMain(argc, argv);
+    }
+	Compiler compiler(&cout);
+	return compiler.compile(argv[1], argc >= 3 ? argv[2] : "", "") ? 0 : 1;
+}
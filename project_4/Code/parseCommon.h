@@ -3,28 +3,71 @@
 
 #include <stdlib.h>
 #include "SyntaxTree.h"
+#include "SourceBuffer.h"
 
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+
+enum SyntaxErrorFlag{NO_SYNTAX_ERROR, NEAR_END_ERROR};
+enum LexErrorFlag{NO_LEX_ERROR, LEX_ERROR};
 
 /*
- * Functions and variables provided by flex.
+ * Receives each ExtDef as soon as it's parsed, when parsing in streaming mode.
+ * The sub tree is destroyed right after handleExtDef() returns.
  */
-extern int yyparse(void);
-extern void yyerror(const char*);
-extern FILE* yyin;
-// extern int yylex(void);
-extern "C" int yylex(void);
-extern void yyrestart(FILE *);
-extern int yylineno;
+class ExtDefHandler
+{
+public:
+    virtual void handleExtDef(Node* extDef) = 0;
+    virtual ~ExtDefHandler(){}
+};
 
 /*
- * Globally used variables.
- * Declared in: syntax.y
- * Defined in: main.cpp 
+ * State of the front end for one compilation.
+ * The scanner and the parser are reentrant and keep everything here instead of in globals,
+ * so different threads can parse different files at the same time, each with its own context.
+ * Token nodes point into the source buffer, so the source must outlive the context's tree.
  */
-extern Node* treeRoot;	
-enum SyntaxErrorFlag{NO_SYNTAX_ERROR, NEAR_END_ERROR};
-extern SyntaxErrorFlag syntaxErrorFlag;
-enum LexErrorFlag{NO_LEX_ERROR, LEX_ERROR};
-extern LexErrorFlag lexErrorFlag;
+class ParseContext
+{
+public:
+    NodePool nodePool;
+    Interner interner;  // names of IDs, filled by the lexer
+    Node* treeRoot;
+    SyntaxErrorFlag syntaxErrorFlag;
+    LexErrorFlag lexErrorFlag;
+    int column;         // column of the next token
+    yyscan_t scanner;
+    ostream* diagnostics;   // lexical and syntax errors, cout by default
+    /*
+     * NULL to build the whole tree.
+     * Otherwise, ExtDefs are passed to it one by one and not kept in the tree,
+     * so memory taken up by the tree is bounded by the largest ExtDef.
+     */
+    ExtDefHandler* extDefHandler;
+    NodePoolMark streamMark;    // where the current ExtDef starts in nodePool, in streaming mode
+
+    ParseContext();
+    ~ParseContext();
+    void parse(SourceBuffer* source);
+    void streamExtDef(Node* extDef, Node** lookahead);
+    bool hasError(){ return lexErrorFlag != NO_LEX_ERROR || syntaxErrorFlag != NO_SYNTAX_ERROR;}
+    void clear();
+};
+
+/*
+ * Functions provided by flex and bison.
+ * yylex() and yyerror() are declared in syntax.y, as they need YYSTYPE and YYLTYPE.
+ */
+extern int yyparse(yyscan_t scanner, ParseContext* context);
+extern int yylex_init_extra(ParseContext* context, yyscan_t* scanner);
+extern int yylex_destroy(yyscan_t scanner);
+extern int yyget_lineno(yyscan_t scanner);
+extern void yyset_lineno(int lineno, yyscan_t scanner);
+extern YY_BUFFER_STATE yy_scan_buffer(char *base, size_t size, yyscan_t scanner);
+extern void yy_delete_buffer(YY_BUFFER_STATE buffer, yyscan_t scanner);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,7 +1,15 @@
-%{
+%code requires {
     #include "parseCommon.h"
+}
 
-%}
+/*
+ * A pure parser with a reentrant scanner,
+ * all the state of a compilation is kept in 'context' (see parseCommon.h).
+ */
+%define api.pure full
+%locations
+%param {yyscan_t scanner}
+%parse-param {ParseContext* context}
 
 /* declared types */
 %union {
@@ -12,34 +20,39 @@
 }
 
 
+%code {
+    int yylex(YYSTYPE* yylval_param, YYLTYPE* yylloc_param, yyscan_t scanner);
+    void yyerror(YYLTYPE* llocp, yyscan_t scanner, ParseContext* context, const char* msg);
+}
+
 /* declared tokens */
 %token <type_node> INT
 %token <type_node> FLOAT
 %token <type_node> ID
-%token <type_node> SEMI
-%token <type_node> COMMA
-%token <type_node> ASSIGNOP 
+%token SEMI
+%token COMMA
+%token ASSIGNOP 
 %token <type_node> RELOP
-%token <type_node> PLUS 
-%token <type_node> MINUS 
-%token <type_node> STAR 
-%token <type_node> DIV
-%token <type_node> AND 
-%token <type_node> OR 
-%token <type_node> NOT
-%token <type_node> DOT
+%token PLUS 
+%token MINUS 
+%token STAR 
+%token DIV
+%token AND 
+%token OR 
+%token NOT
+%token DOT
 %token <type_node> TYPE
-%token <type_node> LP 
-%token <type_node> RP 
-%token <type_node> LB 
-%token <type_node> RB 
-%token <type_node> LC 
-%token <type_node> RC
-%token <type_node> STRUCT
-%token <type_node> RETURN
-%token <type_node> IF 
-%token <type_node> ELSE
-%token <type_node> WHILE
+%token LP 
+%token RP 
+%token LB 
+%token RB 
+%token LC 
+%token RC
+%token STRUCT
+%token RETURN
+%token IF 
+%token ELSE
+%token WHILE
 
 /* declared non-terminals */
 %type <type_node> Program 
@@ -66,404 +79,240 @@
 
 %%
 
+/*
+ * The parser builds an abstract syntax tree:
+ * punctuation, brackets, keywords and operators are not kept as children,
+ * since the production number already tells them apart.
+ * Only ID, INT, FLOAT, TYPE and RELOP leaves are created.
+ * Binary Exp always has its operands as child 0 and 1, so RELOP goes last.
+ * ExtDefList is left recursive, so that each ExtDef is reduced as soon as it ends
+ * and the parser stack doesn't grow with the number of ExtDefs.
+ * In streaming mode the ExtDefs are handed over one by one instead of being kept (see ParseContext).
+ */
+
 /* High-level Definitions */
-Program	: ExtDefList { 
-            $$ = new Node(NODE_TYPE_NON_TERMINAL, "Program", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(0);
-			treeRoot = $$;
+Program	: ExtDefList {
+            $$ = context->nodePool.newNode(NodeKind::Program, @$.first_line, 0, {$1});
+            context->treeRoot = $$;
 		}
 		;
-ExtDefList  : ExtDef ExtDefList {
-				$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDefList", @$.first_line);
-				$$->addChild($1);
-				$$->addChild($2);
-				$$->setProductionNo(0);
+ExtDefList  : ExtDefList ExtDef {
+				if(context->extDefHandler == NULL)
+				{
+					$$ = context->nodePool.newNode(NodeKind::ExtDefList, @$.first_line, 0, {$1, $2});
+				}
+				else
+				{
+					// streaming, the lookahead token (if any has been read) belongs to the next ExtDef
+					bool hasNode = (yychar == INT || yychar == FLOAT || yychar == ID || yychar == RELOP || yychar == TYPE);
+					context->streamExtDef($2, hasNode ? &yylval.type_node : NULL);
+					$$ = NULL;
+				}
             }
             |/* empty */ { $$ = NULL; }
             ;
 ExtDef	: Specifier ExtDecList SEMI{
-	   		$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDef", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(0);
+	   		$$ = context->nodePool.newNode(NodeKind::ExtDef, @$.first_line, 0, {$1, $2});
 		}
 		| Specifier SEMI{
-	   		$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDef", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->setProductionNo(1);
+	   		$$ = context->nodePool.newNode(NodeKind::ExtDef, @$.first_line, 1, {$1});
 		}
 		| Specifier FunDec SEMI{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDef", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(2);
+			$$ = context->nodePool.newNode(NodeKind::ExtDef, @$.first_line, 2, {$1, $2});
 		}
 		| Specifier FunDec CompSt{
-	   		$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDef", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(3);
+	   		$$ = context->nodePool.newNode(NodeKind::ExtDef, @$.first_line, 3, {$1, $2, $3});
 		}
-		| error SEMI { syntaxErrorFlag = NEAR_END_ERROR; }
+		| error SEMI { context->syntaxErrorFlag = NEAR_END_ERROR; }
 		;
 ExtDecList	: VarDec{
-		   		$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDecList", @$.first_line);
-				$$->addChild($1);
-				$$->setProductionNo(0);
+		   		$$ = context->nodePool.newNode(NodeKind::ExtDecList, @$.first_line, 0, {$1});
 			}
 		    | VarDec COMMA ExtDecList{
-	   			$$ = new Node(NODE_TYPE_NON_TERMINAL, "ExtDecList", @$.first_line);
-				$$->addChild($1);
-				$$->addChild($2);
-				$$->addChild($3);
-				$$->setProductionNo(1);
+	   			$$ = context->nodePool.newNode(NodeKind::ExtDecList, @$.first_line, 1, {$1, $3});
 			}
 			;
 
 /* Specifiers */
 Specifier	: TYPE{
-		  		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Specifier", @$.first_line);
-				$$->addChild($1);
-				$$->setProductionNo(0);
+		  		$$ = context->nodePool.newNode(NodeKind::Specifier, @$.first_line, 0, {$1});
 			}
 		  	| StructSpecifier{
-				$$ = new Node(NODE_TYPE_NON_TERMINAL, "Specifier", @$.first_line);
-				$$->addChild($1);
-				$$->setProductionNo(1);
+				$$ = context->nodePool.newNode(NodeKind::Specifier, @$.first_line, 1, {$1});
 			}
 			;
 StructSpecifier	: STRUCT OptTag LC DefList RC{
-					$$ = new Node(NODE_TYPE_NON_TERMINAL, "StructSpecifier", @$.first_line);
-					$$->addChild($1);
-					$$->addChild($2);
-					$$->addChild($3);
-					$$->addChild($4);
-					$$->addChild($5);
-					$$->setProductionNo(0);
+					$$ = context->nodePool.newNode(NodeKind::StructSpecifier, @$.first_line, 0, {$2, $4});
 				}
 				| STRUCT Tag{
-					$$ = new Node(NODE_TYPE_NON_TERMINAL, "StructSpecifier", @$.first_line);
-					$$->addChild($1);
-					$$->addChild($2);
-					$$->setProductionNo(1);
+					$$ = context->nodePool.newNode(NodeKind::StructSpecifier, @$.first_line, 1, {$2});
 				}
 				;
 OptTag	: ID{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "OptTag", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::OptTag, @$.first_line, 0, {$1});
 		}
 	    | /* empty */{ $$=NULL; }
 		;
 Tag	: ID{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Tag", @$.first_line);
-		$$->addChild($1);
-		$$->setProductionNo(0);
+		$$ = context->nodePool.newNode(NodeKind::Tag, @$.first_line, 0, {$1});
 	}
 	;
 
 /* Declarators */
 VarDec : ID{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "VarDec", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::VarDec, @$.first_line, 0, {$1});
 		}
 	   	| VarDec LB INT RB{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "VarDec", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->addChild($4);
-			$$->setProductionNo(1);
+			$$ = context->nodePool.newNode(NodeKind::VarDec, @$.first_line, 1, {$1, $3});
 		}
 	   	;
 FunDec	: ID LP VarList RP{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "FunDec", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->addChild($4);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::FunDec, @$.first_line, 0, {$1, $3});
 		}
 	   	| ID LP RP{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "FunDec", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(1);
+			$$ = context->nodePool.newNode(NodeKind::FunDec, @$.first_line, 1, {$1});
 		}
-		| error RP{ syntaxErrorFlag = NEAR_END_ERROR; }
+		| error RP{ context->syntaxErrorFlag = NEAR_END_ERROR; }
 		;
 VarList	: ParamDec COMMA VarList{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "VarList", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::VarList, @$.first_line, 0, {$1, $3});
 		}
 		| ParamDec{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "VarList", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(1);
+			$$ = context->nodePool.newNode(NodeKind::VarList, @$.first_line, 1, {$1});
 		}
 		;
 ParamDec	: Specifier VarDec{
-				$$ = new Node(NODE_TYPE_NON_TERMINAL, "ParamDec", @$.first_line);
-				$$->addChild($1);
-				$$->addChild($2);
-				$$->setProductionNo(0);
+				$$ = context->nodePool.newNode(NodeKind::ParamDec, @$.first_line, 0, {$1, $2});
 			}
 		 	;
 
 /* Statements */
 CompSt	: LC DefList StmtList RC{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "CompSt", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->addChild($4);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::CompSt, @$.first_line, 0, {$2, $3});
 		}
-		| error RC{ syntaxErrorFlag = NEAR_END_ERROR; }
+		| error RC{ context->syntaxErrorFlag = NEAR_END_ERROR; }
 	   	;
 StmtList	: Stmt StmtList{
-				$$ = new Node(NODE_TYPE_NON_TERMINAL, "StmtList", @$.first_line);
-				$$->addChild($1);
-				$$->addChild($2);
-				$$->setProductionNo(0);
+				$$ = context->nodePool.newNode(NodeKind::StmtList, @$.first_line, 0, {$1, $2});
 			}
 		 	| /* empty */{ $$ = NULL; }
 			;
-Stmt	: Exp SEMI{ 
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Stmt", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->setProductionNo(0);
+Stmt	: Exp SEMI{
+			$$ = context->nodePool.newNode(NodeKind::Stmt, @$.first_line, 0, {$1});
 		}
 	 	| CompSt{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Stmt", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(1);
+			$$ = context->nodePool.newNode(NodeKind::Stmt, @$.first_line, 1, {$1});
 		}
 		| RETURN Exp SEMI{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Stmt", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(2);
+			$$ = context->nodePool.newNode(NodeKind::Stmt, @$.first_line, 2, {$2});
 		}
 		| IF LP Exp RP Stmt %prec LOWER_THAN_ELSE{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Stmt", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->addChild($4);
-			$$->addChild($5);
-			$$->setProductionNo(3);
+			$$ = context->nodePool.newNode(NodeKind::Stmt, @$.first_line, 3, {$3, $5});
 		}
 		| IF LP Exp RP Stmt ELSE Stmt{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Stmt", @$.first_line);
-			$$->addChild($1);$$->addChild($2);$$->addChild($3);
-			$$->addChild($4);$$->addChild($5);$$->addChild($6);$$->addChild($7);
-			$$->setProductionNo(4);
+			$$ = context->nodePool.newNode(NodeKind::Stmt, @$.first_line, 4, {$3, $5, $7});
 		}
 		| WHILE LP Exp RP Stmt{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Stmt", @$.first_line);
-			$$->addChild($1);$$->addChild($2);$$->addChild($3);
-			$$->addChild($4);$$->addChild($5);
-			$$->setProductionNo(5);
+			$$ = context->nodePool.newNode(NodeKind::Stmt, @$.first_line, 5, {$3, $5});
 		}
-		| error RP { syntaxErrorFlag = NEAR_END_ERROR; }
-		| error SEMI { syntaxErrorFlag = NEAR_END_ERROR; }
+		| error RP { context->syntaxErrorFlag = NEAR_END_ERROR; }
+		| error SEMI { context->syntaxErrorFlag = NEAR_END_ERROR; }
 		;
 
 /* Local Definitions */
 DefList	: Def DefList{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "DefList", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::DefList, @$.first_line, 0, {$1, $2});
 		}
 		| /* empty */{ $$ = NULL; }
 		;
 Def	: Specifier DecList SEMI{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Def", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(0);
+		$$ = context->nodePool.newNode(NodeKind::Def, @$.first_line, 0, {$1, $2});
 	}
 	;
 DecList	: Dec{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "DecList", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::DecList, @$.first_line, 0, {$1});
 		}
 		| Dec COMMA DecList{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "DecList", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(1);
+			$$ = context->nodePool.newNode(NodeKind::DecList, @$.first_line, 1, {$1, $3});
 		}
 		;
 Dec	: VarDec{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Dec", @$.first_line);
-		$$->addChild($1);
-		$$->setProductionNo(0);
+		$$ = context->nodePool.newNode(NodeKind::Dec, @$.first_line, 0, {$1});
 	}
 	| VarDec ASSIGNOP Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Dec", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(1);
+		$$ = context->nodePool.newNode(NodeKind::Dec, @$.first_line, 1, {$1, $3});
 	}
 
 /* Expressions */
 Exp	: Exp ASSIGNOP Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(0);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 0, {$1, $3});
 	}
 	| Exp AND Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->setProductionNo(1);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 1, {$1, $3});
 	}
 	| Exp OR Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(2);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 2, {$1, $3});
 	}
 	| Exp RELOP Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(3);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 3, {$1, $3, $2});
 	}
 	| Exp PLUS Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(4);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 4, {$1, $3});
 	}
 	| Exp MINUS Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(5);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 5, {$1, $3});
 	}
 	| Exp STAR Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(6);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 6, {$1, $3});
 	}
 	| Exp DIV Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(7);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 7, {$1, $3});
 	}
 	| LP Exp RP{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(8);
+		/* parentheses only group, the inner Exp takes the place of production 8 */
+		$$ = $2;
 	}
 	| MINUS Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->setProductionNo(9);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 9, {$2});
 	}
 	| NOT Exp{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->setProductionNo(10);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 10, {$2});
 	}
 	| ID LP Args RP{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->addChild($4);
-		$$->setProductionNo(11);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 11, {$1, $3});
 	}
 	| ID LP RP{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(12);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 12, {$1});
 	}
 	| Exp LB Exp RB{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->addChild($4);
-		$$->setProductionNo(13);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 13, {$1, $3});
 	}
 	| Exp DOT ID{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->addChild($2);
-		$$->addChild($3);
-		$$->setProductionNo(14);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 14, {$1, $3});
 	}
 	| ID{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->setProductionNo(15);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 15, {$1});
 	}
 	| INT{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->setProductionNo(16);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 16, {$1});
 	}
 	| FLOAT{
-		$$ = new Node(NODE_TYPE_NON_TERMINAL, "Exp", @$.first_line);
-		$$->addChild($1);
-		$$->setProductionNo(17);
+		$$ = context->nodePool.newNode(NodeKind::Exp, @$.first_line, 17, {$1});
 	}
-	| Exp LB error RB{ syntaxErrorFlag = NEAR_END_ERROR; }
+	| Exp LB error RB{ context->syntaxErrorFlag = NEAR_END_ERROR; }
 	;
 Args	: Exp COMMA Args{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Args", @$.first_line);
-			$$->addChild($1);
-			$$->addChild($2);
-			$$->addChild($3);
-			$$->setProductionNo(0);
+			$$ = context->nodePool.newNode(NodeKind::Args, @$.first_line, 0, {$1, $3});
 		}
 	 	| Exp{
-			$$ = new Node(NODE_TYPE_NON_TERMINAL, "Args", @$.first_line);
-			$$->addChild($1);
-			$$->setProductionNo(1);
+			$$ = context->nodePool.newNode(NodeKind::Args, @$.first_line, 1, {$1});
 		}
 		;
 
 %%
 
 
-void yyerror(const char *msg)
+void yyerror(YYLTYPE*, yyscan_t scanner, ParseContext* context, const char *msg)
 {
-	fprintf(stderr, "Error type B at Line %d: %s\n",yylineno,msg);
+	*context->diagnostics << "Error type B at Line " << yyget_lineno(scanner) << ": " << msg << endl;
 }
\ No newline at end of file
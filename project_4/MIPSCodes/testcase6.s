@@ -0,0 +1,124 @@
+.data
+_prompt: .asciiz "Enter an integer:"
+_ret: .asciiz "\n"
+.globl main
+.text
+read:
+li $v0, 4
+la $a0, _prompt
+syscall
+li $v0, 5
+syscall
+jr $ra
+
+write:
+li $v0, 1
+syscall
+li $v0, 4
+la $a0, _ret
+syscall
+move $v0, $0
+jr $ra
+
+main:
+sw $ra, 0($sp)
+sw $fp, -4($sp)
+move $fp, $sp
+sw $ra, -52($fp)
+sw $fp, -56($fp)
+addi $fp, $fp, -52
+jal read
+lw $fp, -4($fp)
+lw $ra, 0($fp)
+move $t0, $v0
+sw $v0, -48($fp)
+lw $t2, -48($fp)
+move $t1, $t2
+sw $t1, -52($fp)
+sw $ra, -60($fp)
+sw $fp, -64($fp)
+addi $fp, $fp, -60
+jal read
+lw $fp, -4($fp)
+lw $ra, 0($fp)
+move $t3, $v0
+sw $v0, -56($fp)
+lw $t5, -56($fp)
+move $t4, $t5
+sw $t4, -60($fp)
+li $t6, 0
+sw $t6, -64($fp)
+lw $t0, -64($fp)
+move $t7, $t0
+sw $t7, -68($fp)
+lw $t2, -52($fp)
+move $t1, $t2
+sw $t1, -72($fp)
+li $t3, 9
+sw $t3, -76($fp)
+lw $t4, -72($fp)
+lw $t5, -76($fp)
+bgt $t4, $t5, label1
+j label3
+label3:
+li $t6, 4
+sw $t6, -80($fp)
+lw $t7, -60($fp)
+lw $t0, -80($fp)
+move $t7, $t0
+sw $t7, -60($fp)
+lw $t2, -60($fp)
+move $t1, $t2
+sw $t1, -84($fp)
+lw $t4, -68($fp)
+move $t3, $t4
+sw $t3, -88($fp)
+lw $t5, -84($fp)
+lw $t6, -88($fp)
+bgt $t5, $t6, label1
+j label2
+label1:
+lw $t0, -52($fp)
+move $t7, $t0
+sw $t7, -92($fp)
+li $t1, 5
+sw $t1, -96($fp)
+lw $t3, -92($fp)
+lw $t4, -96($fp)
+sub $t2, $t3, $t4
+sw $t2, -100($fp)
+lw $t5, -52($fp)
+lw $t6, -100($fp)
+move $t5, $t6
+sw $t5, -52($fp)
+label2:
+lw $t0, -52($fp)
+move $t7, $t0
+sw $t7, -104($fp)
+lw $t1, -104($fp)
+move $a0, $t1
+sw $ra, -108($fp)
+sw $fp, -112($fp)
+addi $fp, $fp, -108
+jal write
+lw $fp, -4($fp)
+lw $ra, 0($fp)
+lw $t3, -60($fp)
+move $t2, $t3
+sw $t2, -108($fp)
+lw $t4, -108($fp)
+move $a0, $t4
+sw $ra, -112($fp)
+sw $fp, -116($fp)
+addi $fp, $fp, -112
+jal write
+lw $fp, -4($fp)
+lw $ra, 0($fp)
+li $t5, 0
+sw $t5, -112($fp)
+lw $t6, -112($fp)
+move $v0, $t6
+move $v1, $ra
+lw $ra, 0($fp)
+lw $fp, -4($fp)
+jr $v1